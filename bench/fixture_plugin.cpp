@@ -0,0 +1,118 @@
+//-----------------------------------------------------------------------------
+// VST Scanner benchmark fixture
+// Description: Minimal VST3 module whose load behaviour is chosen at compile time
+//-----------------------------------------------------------------------------
+//
+// Built once per behaviour by bench/CMakeLists.txt:
+//   FIXTURE_NAME            class/vendor name prefix
+//   FIXTURE_CLASS_COUNT     classes the factory exports (default 1)
+//   FIXTURE_INIT_DELAY_MS   ModuleEntry sleeps this long (slow initializer)
+//   FIXTURE_HANG            ModuleEntry never returns
+//   FIXTURE_CRASH           ModuleEntry dereferences null (SIGSEGV)
+// The factory only describes classes; createInstance always fails, the scanner never calls it.
+
+#include "pluginterfaces/base/ipluginbase.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#ifndef FIXTURE_NAME
+#define FIXTURE_NAME "Fixture"
+#endif
+
+#ifndef FIXTURE_CLASS_COUNT
+#define FIXTURE_CLASS_COUNT 1
+#endif
+
+using namespace Steinberg;
+
+namespace {
+
+//------------------------------------------------------------------------
+class FixtureFactory : public IPluginFactory
+{
+public:
+    tresult PLUGIN_API queryInterface (const TUID _iid, void** obj) SMTG_OVERRIDE
+    {
+        if (FUnknownPrivate::iidEqual (_iid, IPluginFactory_iid) ||
+            FUnknownPrivate::iidEqual (_iid, FUnknown_iid))
+        {
+            *obj = this;
+            return kResultOk;
+        }
+        *obj = nullptr;
+        return kNoInterface;
+    }
+
+    // One static instance for the module's lifetime.
+    uint32 PLUGIN_API addRef () SMTG_OVERRIDE { return 1; }
+    uint32 PLUGIN_API release () SMTG_OVERRIDE { return 1; }
+
+    tresult PLUGIN_API getFactoryInfo (PFactoryInfo* info) SMTG_OVERRIDE
+    {
+        std::memset (info, 0, sizeof (*info));
+        std::snprintf (info->vendor, sizeof (info->vendor), "%s Audio", FIXTURE_NAME);
+        std::snprintf (info->url, sizeof (info->url), "https://example.invalid/");
+        info->flags = PFactoryInfo::kUnicode;
+        return kResultOk;
+    }
+
+    int32 PLUGIN_API countClasses () SMTG_OVERRIDE { return FIXTURE_CLASS_COUNT; }
+
+    // Alternating processor/controller classes, as a shell module would export them.
+    tresult PLUGIN_API getClassInfo (int32 index, PClassInfo* info) SMTG_OVERRIDE
+    {
+        if (index < 0 || index >= FIXTURE_CLASS_COUNT)
+            return kInvalidArgument;
+
+        std::memset (info, 0, sizeof (*info));
+        std::snprintf (info->cid, sizeof (info->cid), "%.8s%08x", FIXTURE_NAME,
+                       static_cast<unsigned> (index));
+        info->cardinality = PClassInfo::kManyInstances;
+        std::snprintf (info->category, sizeof (info->category), "%s",
+                       index % 2 == 0 ? "Audio Module Class" : "Component Controller Class");
+        std::snprintf (info->name, sizeof (info->name), "%s %d", FIXTURE_NAME,
+                       static_cast<int> (index));
+        return kResultOk;
+    }
+
+    tresult PLUGIN_API createInstance (FIDString, FIDString, void** obj) SMTG_OVERRIDE
+    {
+        *obj = nullptr;
+        return kNotImplemented;
+    }
+};
+
+FixtureFactory factory;
+
+} // anonymous
+
+//------------------------------------------------------------------------
+extern "C" {
+
+SMTG_EXPORT_SYMBOL bool ModuleEntry (void*)
+{
+#if defined(FIXTURE_CRASH)
+    volatile int* null = nullptr;
+    *null = 1;
+#elif defined(FIXTURE_HANG)
+    for (;;)
+        std::this_thread::sleep_for (std::chrono::hours (1));
+#elif defined(FIXTURE_INIT_DELAY_MS)
+    std::this_thread::sleep_for (std::chrono::milliseconds (FIXTURE_INIT_DELAY_MS));
+#endif
+    return true;
+}
+
+SMTG_EXPORT_SYMBOL bool ModuleExit ()
+{
+    return true;
+}
+
+SMTG_EXPORT_SYMBOL IPluginFactory* PLUGIN_API GetPluginFactory ()
+{
+    return &factory;
+}
+
+} // extern "C"
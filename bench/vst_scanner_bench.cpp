@@ -0,0 +1,1004 @@
+//-----------------------------------------------------------------------------
+// VST Scanner benchmark
+// Description: Times discovery, marker scanning, factory loads, JSON and merge on a generated
+//              tree of synthetic VST3 modules (Linux)
+//-----------------------------------------------------------------------------
+
+#include "vst_scanner.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#ifndef VST_SCANNER_FIXTURE_DIR
+#error "VST_SCANNER_FIXTURE_DIR must name the directory holding the built fixture_*.so modules"
+#endif
+
+namespace {
+
+namespace fs = std::filesystem;
+
+//------------------------------------------------------------------------
+const char* linuxArchDirectory ()
+{
+#if defined(__x86_64__)
+    return "x86_64-linux";
+#elif defined(__aarch64__)
+    return "aarch64-linux";
+#elif defined(__i386__)
+    return "i386-linux";
+#else
+    return "unknown-linux";
+#endif
+}
+
+fs::path fixtureModule (const char* kind)
+{
+    return fs::path (VST_SCANNER_FIXTURE_DIR) / (std::string ("fixture_") + kind + ".so");
+}
+
+// <dir>/<name>.vst3/Contents/<arch>-linux/<name>.so, the layout Module::create expects.
+void makeBundle (const fs::path& dir, const std::string& name, const char* kind)
+{
+    const auto binaryDir = dir / (name + ".vst3") / "Contents" / linuxArchDirectory ();
+    fs::create_directories (binaryDir);
+    fs::copy_file (fixtureModule (kind), binaryDir / (name + ".so"),
+                   fs::copy_options::overwrite_existing);
+}
+
+// A monolithic .vst3 with a PACE marker in its last megabyte, where the tail window finds it.
+void makeLicensedModule (const fs::path& path, std::mt19937_64& rng)
+{
+    std::ifstream in (fixtureModule ("fast"), std::ios::binary);
+    std::string bytes ((std::istreambuf_iterator<char> (in)), std::istreambuf_iterator<char> ());
+    bytes.resize (6 * 1024 * 1024, '\0');
+    for (size_t i = bytes.size () / 2; i < bytes.size (); i += 8)
+    {
+        const uint64_t value = rng ();
+        std::memcpy (&bytes[i], &value, (std::min) (sizeof (value), bytes.size () - i));
+    }
+    const char marker[] = "PACEFusion runtime";
+    std::memcpy (&bytes[bytes.size () - 512 * 1024], marker, sizeof (marker));
+    std::ofstream (path, std::ios::binary).write (bytes.data (), bytes.size ());
+}
+
+// 50 vendors x 20 products, each product folder holding 5 bundles (4 entries each), 10 loose
+// .so modules and 70 resource files: 100 entries a folder, ~101k in all. Discovery never reads
+// a module, so every file is empty and the tree costs inodes, not disk.
+void makeDiscoveryTree (const fs::path& root)
+{
+    for (unsigned vendor = 0; vendor < 50; ++vendor)
+    {
+        for (unsigned product = 0; product < 20; ++product)
+        {
+            const auto dir = root / ("Vendor" + std::to_string (vendor)) /
+                             ("Product" + std::to_string (product));
+            for (unsigned i = 0; i < 5; ++i)
+            {
+                const auto name = "Bundle" + std::to_string (i);
+                const auto binaryDir = dir / (name + ".vst3") / "Contents" / linuxArchDirectory ();
+                fs::create_directories (binaryDir);
+                std::ofstream (binaryDir / (name + ".so"));
+            }
+            for (unsigned i = 0; i < 10; ++i)
+                std::ofstream (dir / ("Loose" + std::to_string (i) + ".so"));
+            for (unsigned i = 0; i < 70; ++i)
+                std::ofstream (dir / ("preset" + std::to_string (i) + ".vstpreset"));
+        }
+    }
+}
+
+//------------------------------------------------------------------------
+// The fixture tree. Every directory below the root is one benchmark input:
+//   vendors/   fast bundles spread over 20 vendor folders (200 x scale)
+//   multi/     bundles whose factory exports 64 classes
+//   slow/      bundles whose ModuleEntry sleeps 100 ms
+//   broken/    one bundle that hangs in ModuleEntry, one that segfaults
+//   licensed/  monolithic .vst3 files with a PACE marker near the end
+//   loose/     plain .so modules
+//   deep/      a bundle 48 directories down, beside 500 empty sibling directories
+//   discovery/ ~100k entries of empty files for the walk alone, made only when a discovery
+//              benchmark runs (see makeDiscoveryTree)
+// A stamp file marks the tree as ours; an existing directory without it is never deleted.
+void generateFixtures (const fs::path& root, unsigned scale)
+{
+    const auto stamp = root / ".vst_scanner_bench";
+    if (fs::exists (root) && !fs::is_empty (root) && !fs::exists (stamp))
+        throw std::runtime_error (root.string () + " exists and is not a fixture tree");
+    fs::remove_all (root);
+    fs::create_directories (root);
+    std::ofstream (stamp) << "generated by vst_scanner_bench\n";
+
+    std::mt19937_64 rng (0x5eed);
+
+    for (unsigned i = 0; i < 200 * scale; ++i)
+    {
+        makeBundle (root / "vendors" / ("Vendor" + std::to_string (i % 20)),
+                    "Fast" + std::to_string (i), "fast");
+    }
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        makeBundle (root / "multi", "Shell" + std::to_string (i), "multi");
+        makeBundle (root / "slow", "Slow" + std::to_string (i), "slow");
+    }
+    makeBundle (root / "broken", "Hang", "hang");
+    makeBundle (root / "broken", "Crash", "crash");
+
+    fs::create_directories (root / "licensed");
+    for (unsigned i = 0; i < 8; ++i)
+    {
+        makeLicensedModule (root / "licensed" / ("Protected" + std::to_string (i) + ".vst3"),
+                            rng);
+    }
+
+    fs::create_directories (root / "loose");
+    for (unsigned i = 0; i < 20; ++i)
+    {
+        fs::copy_file (fixtureModule ("fast"),
+                       root / "loose" / ("loose" + std::to_string (i) + ".so"),
+                       fs::copy_options::overwrite_existing);
+    }
+
+    auto deep = root / "deep" / "nested";
+    for (unsigned level = 0; level < 48; ++level)
+        deep /= "level" + std::to_string (level);
+    makeBundle (deep, "Deep", "fast");
+    for (unsigned i = 0; i < 500; ++i)
+        fs::create_directories (root / "deep" / "wide" / ("empty" + std::to_string (i)));
+}
+
+//------------------------------------------------------------------------
+// Records shaped like real scan output: a few categories, classes, and both valid and failed
+// entries. The seed makes every run produce the same catalog.
+std::vector<VSTScanner::PluginInfo> syntheticCatalog (size_t count, uint64_t seed)
+{
+    std::mt19937_64 rng (seed);
+    std::vector<VSTScanner::PluginInfo> plugins (count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto& p = plugins[i];
+        const auto id = std::to_string (rng () % (count * 2));
+        p.path = "/usr/lib/vst3/Vendor" + std::to_string (rng () % 200) + "/Plugin" + id + ".vst3";
+        p.name = "Plugin \"" + id + "\"";
+        p.vendor = "Vendor " + std::to_string (rng () % 200);
+        p.version = "1." + std::to_string (rng () % 10) + ".0";
+        p.categories = {"Fx", (rng () % 2) ? "EQ" : "Dynamics"};
+        p.cid = "CID" + id;
+        p.sdkVersion = "VST 3.7.9";
+        p.cardinality = 0x7fffffff;
+        p.isValid = rng () % 10 != 0;
+        p.loadFailed = !p.isValid;
+        p.errorMessage = p.isValid ? "" : "Could not load module\n(error " + id + ")";
+        p.scanSource = "factory";
+        p.analysis.analyzed = true;
+        p.analysis.moduleSize = rng () % (64u << 20);
+        for (int c = 0; c < 2; ++c)
+        {
+            VSTScanner::PluginClassInfo cls;
+            cls.name = p.name;
+            cls.category = c == 0 ? "Audio Module Class" : "Component Controller Class";
+            cls.cid = p.cid + std::to_string (c);
+            cls.vendor = p.vendor;
+            cls.version = p.version;
+            cls.sdkVersion = p.sdkVersion;
+            if (c == 0)
+                cls.subCategories = p.categories;
+            p.classes.push_back (std::move (cls));
+        }
+    }
+    return plugins;
+}
+
+//------------------------------------------------------------------------
+// Round-trip fuzzing for the JSON reader. Strings draw on quotes, backslashes, control
+// characters and multi-byte UTF-8; catalogs include empty arrays and extreme numbers.
+std::string fuzzString (std::mt19937_64& rng)
+{
+    static const char* const pieces[] = {
+        "a", "Z", "9", " ", "/", "\\", "\"", "\n", "\t", "\r", "\x01", "\x1f", "\x7f", "\b",
+        "\xc3\xa9", "\xe9\x9f\xb3", "\xf0\x9f\x98\x80", "{", "}", "[", "]", ":", ",", "\\u0041",
+    };
+    std::string out;
+    for (size_t n = rng () % 24; n > 0; --n)
+        out += pieces[rng () % std::size (pieces)];
+    return out;
+}
+
+std::vector<std::string> fuzzStrings (std::mt19937_64& rng, size_t maxCount)
+{
+    std::vector<std::string> out (rng () % (maxCount + 1));
+    for (auto& s : out)
+        s = fuzzString (rng);
+    return out;
+}
+
+std::vector<VSTScanner::PluginInfo> fuzzCatalog (std::mt19937_64& rng)
+{
+    std::vector<VSTScanner::PluginInfo> plugins (rng () % 40);
+    for (auto& p : plugins)
+    {
+        p.path = fuzzString (rng);
+        p.name = fuzzString (rng);
+        p.vendor = fuzzString (rng);
+        p.version = fuzzString (rng);
+        p.categories = fuzzStrings (rng, 3);
+        p.cid = fuzzString (rng);
+        p.sdkVersion = fuzzString (rng);
+        p.cardinality = static_cast<int32_t> (static_cast<uint32_t> (rng ()));
+        p.flags = static_cast<uint32_t> (rng ());
+        p.isValid = rng () % 2 == 0;
+        p.missingLicense = rng () % 2 == 0;
+        p.loadFailed = rng () % 2 == 0;
+        p.loadTimedOut = rng () % 2 == 0;
+        p.errorMessage = fuzzString (rng);
+        p.scanSource = rng () % 4 == 0 ? std::string () : fuzzString (rng);
+        p.aliases = fuzzStrings (rng, 2);
+        p.analysis.analyzed = rng () % 2 == 0;
+        p.analysis.moduleSize = rng ();
+        p.analysis.licenseWrappers = fuzzStrings (rng, 2);
+        p.analysis.licenseMarkers = rng () % 2 == 0;
+        p.analysis.headlessUnsafeVendor = rng () % 2 == 0;
+        p.analysis.binaryProblem = rng () % 2 ? std::string () : fuzzString (rng);
+        for (size_t c = rng () % 4; c > 0; --c)
+        {
+            VSTScanner::PluginClassInfo cls;
+            cls.name = fuzzString (rng);
+            cls.category = fuzzString (rng);
+            cls.subCategories = fuzzStrings (rng, 3);
+            cls.cid = fuzzString (rng);
+            cls.vendor = fuzzString (rng);
+            cls.version = fuzzString (rng);
+            cls.sdkVersion = fuzzString (rng);
+            cls.cardinality = static_cast<int32_t> (static_cast<uint32_t> (rng ()));
+            cls.flags = static_cast<uint32_t> (rng ());
+            p.classes.push_back (std::move (cls));
+        }
+    }
+    return plugins;
+}
+
+// What a catalog record carries: failure fields for failed plugins, class data for valid ones,
+// the analysis only if there was one, no timings.
+VSTScanner::PluginInfo jsonView (const VSTScanner::PluginInfo& p)
+{
+    VSTScanner::PluginInfo view;
+    view.path = p.path;
+    view.isValid = p.isValid;
+    view.scanSource = p.scanSource;
+    view.aliases = p.aliases;
+    if (p.analysis.analyzed)
+        view.analysis = p.analysis;
+    if (p.isValid)
+    {
+        view.name = p.name;
+        view.vendor = p.vendor;
+        view.version = p.version;
+        view.categories = p.categories;
+        view.cid = p.cid;
+        view.sdkVersion = p.sdkVersion;
+        view.cardinality = p.cardinality;
+        view.flags = p.flags;
+        view.classes = p.classes;
+    }
+    else
+    {
+        view.missingLicense = p.missingLicense;
+        view.loadFailed = p.loadFailed;
+        view.loadTimedOut = p.loadTimedOut;
+        view.errorMessage = p.errorMessage;
+    }
+    return view;
+}
+
+bool sameClass (const VSTScanner::PluginClassInfo& a, const VSTScanner::PluginClassInfo& b)
+{
+    return a.name == b.name && a.category == b.category && a.subCategories == b.subCategories &&
+           a.cid == b.cid && a.vendor == b.vendor && a.version == b.version &&
+           a.sdkVersion == b.sdkVersion && a.cardinality == b.cardinality && a.flags == b.flags;
+}
+
+// The first field in which the records differ, or nullptr.
+const char* pluginDifference (const VSTScanner::PluginInfo& a, const VSTScanner::PluginInfo& b)
+{
+    const auto& x = a.analysis;
+    const auto& y = b.analysis;
+    const std::pair<const char*, bool> fields[] = {
+        {"path", a.path == b.path},
+        {"name", a.name == b.name},
+        {"vendor", a.vendor == b.vendor},
+        {"version", a.version == b.version},
+        {"categories", a.categories == b.categories},
+        {"cid", a.cid == b.cid},
+        {"sdkVersion", a.sdkVersion == b.sdkVersion},
+        {"cardinality", a.cardinality == b.cardinality},
+        {"flags", a.flags == b.flags},
+        {"isValid", a.isValid == b.isValid},
+        {"missingLicense", a.missingLicense == b.missingLicense},
+        {"loadFailed", a.loadFailed == b.loadFailed},
+        {"loadTimedOut", a.loadTimedOut == b.loadTimedOut},
+        {"errorMessage", a.errorMessage == b.errorMessage},
+        {"scanSource", a.scanSource == b.scanSource},
+        {"aliases", a.aliases == b.aliases},
+        {"analysis", x.analyzed == y.analyzed && x.moduleSize == y.moduleSize &&
+                         x.licenseWrappers == y.licenseWrappers &&
+                         x.licenseMarkers == y.licenseMarkers &&
+                         x.headlessUnsafeVendor == y.headlessUnsafeVendor &&
+                         x.binaryProblem == y.binaryProblem},
+        {"classes", std::equal (a.classes.begin (), a.classes.end (), b.classes.begin (),
+                                b.classes.end (), sameClass)},
+    };
+    for (const auto& field : fields)
+    {
+        if (!field.second)
+            return field.first;
+    }
+    return nullptr;
+}
+
+// Rewrites writer output the way other tools might: any whitespace between tokens, and string
+// characters spelled as \u escapes (surrogate pairs above the BMP) or \/. Values are unchanged.
+std::string reformatJSON (const std::string& json, std::mt19937_64& rng)
+{
+    static const char* const spaces[] = {"", "", " ", "\n", "\t", "\r\n", "   \n  "};
+    static const char* const hex[] = {"0123456789abcdef", "0123456789ABCDEF"};
+    const auto escape = [&] (std::string& out, uint32_t unit) {
+        const char* digits = hex[rng () % 2];
+        out += "\\u";
+        for (int shift = 12; shift >= 0; shift -= 4)
+            out += digits[(unit >> shift) & 0xF];
+    };
+
+    std::string out;
+    bool inString = false;
+    for (size_t i = 0; i < json.size (); ++i)
+    {
+        const unsigned char c = static_cast<unsigned char> (json[i]);
+        if (!inString)
+        {
+            if (c == ' ' || c == '\n' || c == '\t' || c == '\r')
+                continue;
+            if (std::strchr ("{}[]:,\"", c))
+                out += spaces[rng () % std::size (spaces)];
+            out += static_cast<char> (c);
+            inString = c == '"';
+            continue;
+        }
+
+        if (c == '"')
+        {
+            out += '"';
+            inString = false;
+        }
+        else if (c == '\\')
+        {
+            const size_t length = json[i + 1] == 'u' ? 6 : 2;
+            out.append (json, i, length);
+            i += length - 1;
+        }
+        else if (c < 0x80)
+        {
+            if (c == '/' && rng () % 2)
+                out += "\\/";
+            else if (rng () % 8 == 0)
+                escape (out, c);
+            else
+                out += static_cast<char> (c);
+        }
+        else
+        {
+            // A UTF-8 sequence; the writer passes them through unchanged.
+            const size_t length = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : 2;
+            if (rng () % 2)
+            {
+                out.append (json, i, length);
+            }
+            else
+            {
+                uint32_t cp = c & (0x7F >> length);
+                for (size_t k = 1; k < length; ++k)
+                    cp = (cp << 6) | (static_cast<unsigned char> (json[i + k]) & 0x3F);
+                if (cp >= 0x10000)
+                {
+                    escape (out, 0xD800 + ((cp - 0x10000) >> 10));
+                    escape (out, 0xDC00 + ((cp - 0x10000) & 0x3FF));
+                }
+                else
+                {
+                    escape (out, cp);
+                }
+            }
+            i += length - 1;
+        }
+    }
+    return out + spaces[rng () % std::size (spaces)];
+}
+
+// Damages valid JSON: truncation, flipped or structural bytes, dropped or repeated spans, and
+// fragments that stress the reader (lone surrogates, huge exponents, deep nesting).
+std::string mutateJSON (std::string json, std::mt19937_64& rng)
+{
+    static const std::string fragments[] = {
+        "\\u", "\\uD800", "\\uDC00\\u", "\\x", "-", "1e999999", "-0.e", "tru", "nul",
+        "\"", "\\", "{\"plugins\": [", "99999999999999999999999999", "\xff\xfe",
+        std::string (200, '['), std::string (200, '{'),
+    };
+    static const char structural[] = "\"\\{}[]:,u0-e";
+    for (size_t n = 1 + rng () % 4; n > 0 && !json.empty (); --n)
+    {
+        const size_t at = rng () % json.size ();
+        const size_t span = (std::min) (json.size () - at, size_t (1 + rng () % 64));
+        switch (rng () % 5)
+        {
+            case 0: json.resize (at); break;
+            case 1: json[at] = structural[rng () % (sizeof (structural) - 1)]; break;
+            case 2: json.erase (at, span); break;
+            case 3: json.insert (at, json.substr (at, span)); break;
+            default: json.insert (at, fragments[rng () % std::size (fragments)]); break;
+        }
+    }
+    return json;
+}
+
+// The marker check before the Aho-Corasick matcher: lowercase the chunk, then one find per
+// needle. Same needles as bufferHasLicenseMarkers.
+bool naiveChunkHasLicenseMarker (const char* data, size_t size)
+{
+    static const char* const needles[] = {
+        "pacefusion",      "paceeden", "wraptool", "ilok", "noauthorizedlicensesfound",
+        "authorization required", "licensedaemon",
+    };
+    std::string lower (data, size);
+    for (auto& c : lower)
+        c = static_cast<char> (std::tolower (static_cast<unsigned char> (c)));
+    for (const char* needle : needles)
+    {
+        if (lower.find (needle) != std::string::npos)
+            return true;
+    }
+    return false;
+}
+
+//------------------------------------------------------------------------
+struct BenchResult
+{
+    std::string name;
+    unsigned iterations {0};
+    double medianMs {0};
+    double minMs {0};
+    size_t items {0}; // per iteration: plugins, files, bytes...
+    const char* unit {""};
+};
+
+class BenchRunner
+{
+public:
+    BenchRunner (std::string filter, unsigned iterations)
+    : filter (std::move (filter)), iterations (iterations)
+    {
+    }
+
+    // body returns how many items one iteration processed. Heavy benchmarks pass their own
+    // iteration cap so a run stays in the seconds.
+    // For benchmarks that also check results; any failure makes the bench exit non-zero.
+    void fail (const std::string& name, const std::string& message)
+    {
+        std::cerr << "  " << name << ": FAILED: " << message << std::endl;
+        ++failures;
+    }
+
+    bool failed () const { return failures > 0; }
+
+    bool selected (const std::string& name) const
+    {
+        return filter.empty () || name.find (filter) != std::string::npos;
+    }
+
+    void run (const std::string& name, const char* unit, unsigned maxIterations,
+              const std::function<size_t ()>& body)
+    {
+        if (!selected (name))
+            return;
+
+        const unsigned count = (std::max) (1u, (std::min) (iterations, maxIterations));
+        std::vector<double> samples;
+        size_t items = 0;
+        for (unsigned i = 0; i < count; ++i)
+        {
+            const auto started = std::chrono::steady_clock::now ();
+            items = body ();
+            samples.push_back (std::chrono::duration<double, std::milli> (
+                                   std::chrono::steady_clock::now () - started)
+                                   .count ());
+        }
+        std::sort (samples.begin (), samples.end ());
+
+        BenchResult result;
+        result.name = name;
+        result.iterations = count;
+        result.medianMs = samples[samples.size () / 2];
+        result.minMs = samples.front ();
+        result.items = items;
+        result.unit = unit;
+        results.push_back (result);
+
+        std::cerr << "  " << name << ": " << result.medianMs << " ms" << std::endl;
+    }
+
+    void writeTable (std::ostream& out) const
+    {
+        out << std::left << std::setw (34) << "benchmark" << std::right << std::setw (6) << "iter"
+            << std::setw (12) << "median ms" << std::setw (12) << "min ms" << std::setw (16)
+            << "throughput" << std::endl;
+        for (const auto& r : results)
+        {
+            out << std::left << std::setw (34) << r.name << std::right << std::setw (6)
+                << r.iterations << std::fixed << std::setprecision (3) << std::setw (12)
+                << r.medianMs << std::setw (12) << r.minMs << std::setw (12)
+                << std::setprecision (0)
+                << (r.medianMs > 0 ? static_cast<double> (r.items) * 1000.0 / r.medianMs : 0.0)
+                << " " << r.unit << "/s" << std::defaultfloat << std::setprecision (6)
+                << std::endl;
+        }
+    }
+
+    void writeJSON (std::ostream& out) const
+    {
+        out << "{\"benchmarks\": [";
+        for (size_t i = 0; i < results.size (); ++i)
+        {
+            const auto& r = results[i];
+            out << (i > 0 ? ",\n  " : "\n  ") << "{\"name\": \""
+                << VSTScanner::escapeJSONString (r.name) << "\", \"iterations\": " << r.iterations
+                << ", \"medianMs\": " << r.medianMs << ", \"minMs\": " << r.minMs
+                << ", \"items\": " << r.items << ", \"unit\": \"" << r.unit << "\"}";
+        }
+        out << "\n]}" << std::endl;
+    }
+
+private:
+    std::string filter;
+    unsigned iterations;
+    std::vector<BenchResult> results;
+    size_t failures {0};
+};
+
+//------------------------------------------------------------------------
+VSTScanner::ScanOptions benchScanOptions (unsigned jobs)
+{
+    VSTScanner::ScanOptions options;
+    options.quiet = true;
+    options.jobs = jobs;
+    options.factoryLoadTimeoutSec = 1;
+    return options;
+}
+
+size_t scanDirectory (const fs::path& dir, const VSTScanner::ScanOptions& options)
+{
+    const auto paths = VSTScanner::findVSTFiles (dir.string ());
+    return VSTScanner::scanPlugins (paths, options).size ();
+}
+
+void runBenchmarks (BenchRunner& bench, const fs::path& root)
+{
+    const unsigned cores = (std::max) (1u, std::thread::hardware_concurrency ());
+
+    // Discovery: the 100k-entry tree, then the deep and wide one. Creating 100k files takes
+    // longer than walking them many times over, so other runs skip it.
+    if (bench.selected ("discovery/100k-entries-1-thread") ||
+        bench.selected ("discovery/100k-entries-all-cores"))
+        makeDiscoveryTree (root / "discovery");
+    bench.run ("discovery/100k-entries-1-thread", "modules", 10, [&] () {
+        return VSTScanner::findVSTFiles ((root / "discovery").string (), 1).size ();
+    });
+    bench.run ("discovery/100k-entries-all-cores", "modules", 10, [&] () {
+        return VSTScanner::findVSTFiles ((root / "discovery").string ()).size ();
+    });
+    bench.run ("discovery/deep-all-cores", "modules", 50, [&] () {
+        return VSTScanner::findVSTFiles ((root / "deep").string ()).size ();
+    });
+
+    // Marker scanning: a 100 MiB marker-free binary is the worst case, every byte is looked
+    // at. Every needle contains an 'e' or an 'o', so letters without those give partial
+    // matches but never a hit; runs of NUL and high bytes between them stand in for code and
+    // data sections.
+    {
+        constexpr size_t kMiB = 100;
+        std::mt19937_64 rng (42);
+        const std::string alphabet = "abcdfghijklmnpqrstuvwxyz ABCDFGHIJKLMNPQRSTUVWXYZ";
+        std::string buffer (kMiB << 20, '\0');
+        for (size_t i = 0; i < buffer.size (); ++i)
+        {
+            const uint64_t r = rng ();
+            buffer[i] = (i & 4095) < 3072 ? alphabet[r % alphabet.size ()]
+                                          : static_cast<char> ((r & 1) ? 0 : 0x80 | (r >> 8));
+        }
+
+        bench.run ("markers/aho-corasick-100MiB", "MiB", 20, [&] () {
+            return VSTScanner::bufferHasLicenseMarkers (buffer.data (), buffer.size ())
+                       ? size_t (0)
+                       : kMiB;
+        });
+        bench.run ("markers/naive-100MiB", "MiB", 20, [&] () {
+            return naiveChunkHasLicenseMarker (buffer.data (), buffer.size ()) ? size_t (0)
+                                                                                : kMiB;
+        });
+    }
+    bench.run ("markers/analyze-licensed", "modules", 50, [&] () {
+        size_t protectedCount = 0;
+        for (const auto& entry : fs::directory_iterator (root / "licensed"))
+            protectedCount += VSTScanner::analyzeModule (entry.path ()).needsLicense () ? 1 : 0;
+        return protectedCount;
+    });
+
+    // Factory loads. Hangs and crashes are only loaded in isolated workers.
+    bench.run ("load/fast-1-job", "plugins", 10, [&] () {
+        return scanDirectory (root / "vendors", benchScanOptions (1));
+    });
+    bench.run ("load/fast-all-cores", "plugins", 10, [&] () {
+        return scanDirectory (root / "vendors", benchScanOptions (0));
+    });
+    bench.run ("load/multi-class", "plugins", 10, [&] () {
+        return scanDirectory (root / "multi", benchScanOptions (1));
+    });
+    bench.run ("load/slow-init-4-jobs", "plugins", 5, [&] () {
+        return scanDirectory (root / "slow", benchScanOptions (4));
+    });
+    bench.run ("load/loose-so", "plugins", 10, [&] () {
+        return scanDirectory (root / "loose", benchScanOptions (1));
+    });
+    bench.run ("load/isolated-fast", "plugins", 5, [&] () {
+        auto options = benchScanOptions (cores);
+        options.isolateFactoryLoad = true;
+        return scanDirectory (root / "vendors", options);
+    });
+    bench.run ("load/isolated-hang-crash", "plugins", 1, [&] () {
+        auto options = benchScanOptions (2);
+        options.isolateFactoryLoad = true;
+        return scanDirectory (root / "broken", options);
+    });
+    {
+        const auto cacheFile = root / "bench.cache";
+        fs::remove (cacheFile);
+        auto options = benchScanOptions (1);
+        options.cacheFile = cacheFile.string ();
+        scanDirectory (root / "vendors", options);
+        bench.run ("load/warm-cache", "plugins", 20, [&] () {
+            return scanDirectory (root / "vendors", options);
+        });
+    }
+
+    // Catalog JSON and merge
+    const auto catalog = syntheticCatalog (20000, 1);
+    std::string json;
+    bench.run ("json/write-20k", "plugins", 10, [&] () {
+        std::ostringstream out;
+        VSTScanner::outputJSON (catalog, out);
+        json = out.str ();
+        return catalog.size ();
+    });
+    if (json.empty ())
+    {
+        std::ostringstream out;
+        VSTScanner::outputJSON (catalog, out);
+        json = out.str ();
+    }
+    bench.run ("json/parse-20k", "plugins", 10, [&] () {
+        return VSTScanner::parseJSONCatalog (json.data (), json.size ()).size ();
+    });
+
+    // The reader against the writer: random catalogs, as JSON and as NDJSON, reformatted and
+    // re-escaped, must parse back to what was written; damaged input must neither throw nor
+    // crash. Either kind of failure fails the bench.
+    bench.run ("fuzz/json-roundtrip", "catalogs", 1, [&] () {
+        const char* name = "fuzz/json-roundtrip";
+        std::mt19937_64 rng (10);
+        constexpr size_t kRounds = 500;
+        for (size_t round = 0; round < kRounds; ++round)
+        {
+            const auto plugins = fuzzCatalog (rng);
+            std::ostringstream out;
+            if (round % 3 == 2)
+            {
+                VSTScanner::NDJSONWriter writer (out);
+                for (const auto& plugin : plugins)
+                    writer.write (plugin);
+                writer.writeSummary ();
+            }
+            else
+            {
+                VSTScanner::outputJSON (plugins, out);
+            }
+            const auto text = reformatJSON (out.str (), rng);
+            const auto where = "round " + std::to_string (round);
+
+            std::vector<VSTScanner::PluginInfo> parsed;
+            try
+            {
+                parsed = VSTScanner::parseJSONCatalog (text.data (), text.size ());
+            }
+            catch (const std::exception& e)
+            {
+                bench.fail (name, where + ": threw " + e.what ());
+                return round;
+            }
+            if (parsed.size () != plugins.size ())
+            {
+                bench.fail (name, where + ": " + std::to_string (parsed.size ()) + " of " +
+                                      std::to_string (plugins.size ()) + " plugins read back");
+                return round;
+            }
+            for (size_t i = 0; i < plugins.size (); ++i)
+            {
+                if (const char* field = pluginDifference (jsonView (plugins[i]), parsed[i]))
+                {
+                    bench.fail (name, where + ", plugin " + std::to_string (i) + ": " + field +
+                                          " differs");
+                    return round;
+                }
+            }
+        }
+        return kRounds;
+    });
+    bench.run ("fuzz/json-malformed", "inputs", 1, [&] () {
+        std::mt19937_64 rng (11);
+        constexpr size_t kInputs = 20000;
+        std::string valid;
+        for (size_t i = 0; i < kInputs; ++i)
+        {
+            if (i % 500 == 0)
+            {
+                std::ostringstream out;
+                VSTScanner::outputJSON (fuzzCatalog (rng), out);
+                valid = reformatJSON (out.str (), rng);
+            }
+            const auto damaged = mutateJSON (valid, rng);
+            try
+            {
+                VSTScanner::parseJSONCatalog (damaged.data (), damaged.size ());
+            }
+            catch (const std::exception& e)
+            {
+                bench.fail ("fuzz/json-malformed",
+                            "input " + std::to_string (i) + ": threw " + e.what ());
+                return i;
+            }
+        }
+        return kInputs;
+    });
+    // The binary catalog keeps every field, whatever the plugin's state, so records must come
+    // back exactly as written, whole and through the path index.
+    bench.run ("fuzz/bin-roundtrip", "catalogs", 1, [&] () {
+        const char* name = "fuzz/bin-roundtrip";
+        const auto binFile = root / "fuzz.bin";
+        std::mt19937_64 rng (12);
+        constexpr size_t kRounds = 500;
+        for (size_t round = 0; round < kRounds; ++round)
+        {
+            const auto plugins = fuzzCatalog (rng);
+            {
+                std::ofstream out (binFile, std::ios::binary | std::ios::trunc);
+                VSTScanner::outputBinaryCatalog (plugins, out);
+            }
+            const auto where = "round " + std::to_string (round);
+
+            const auto parsed = VSTScanner::loadCatalogFile (binFile.string ());
+            if (parsed.size () != plugins.size ())
+            {
+                bench.fail (name, where + ": " + std::to_string (parsed.size ()) + " of " +
+                                      std::to_string (plugins.size ()) + " plugins read back");
+                return round;
+            }
+            const VSTScanner::BinaryCatalogView view (binFile.string ());
+            for (size_t i = 0; i < plugins.size (); ++i)
+            {
+                const char* field = pluginDifference (plugins[i], parsed[i]);
+                const size_t found = view.findPath (plugins[i].path);
+                if (!field && (found == VSTScanner::BinaryCatalogView::npos ||
+                               view.path (found) != plugins[i].path))
+                    field = "path index";
+                if (field)
+                {
+                    bench.fail (name, where + ", plugin " + std::to_string (i) + ": " + field +
+                                          " differs");
+                    return round;
+                }
+            }
+        }
+        fs::remove (binFile);
+        return kRounds;
+    });
+
+    // The large-catalog writers: in memory, to a file (block writes reach the kernel), and as
+    // NDJSON, one flushed record per plugin.
+    {
+        const auto large = syntheticCatalog (100000, 3);
+        const auto jsonFile = root / "bench.json";
+        bench.run ("json/write-100k", "plugins", 5, [&] () {
+            std::ostringstream out;
+            VSTScanner::outputJSON (large, out);
+            return large.size ();
+        });
+        bench.run ("json/write-100k-file", "plugins", 5, [&] () {
+            std::ofstream out (jsonFile, std::ios::binary);
+            VSTScanner::outputJSON (large, out);
+            return large.size ();
+        });
+        bench.run ("json/ndjson-100k-file", "plugins", 5, [&] () {
+            std::ofstream out (jsonFile, std::ios::binary);
+            VSTScanner::NDJSONWriter writer (out);
+            for (const auto& plugin : large)
+                writer.write (plugin);
+            writer.writeSummary ();
+            return large.size ();
+        });
+        fs::remove (jsonFile);
+
+        // The binary catalog queried in place (map, then 1000 indexed lookups) against
+        // materializing it with loadCatalogFile.
+        const auto binFile = root / "bench.bin";
+        {
+            std::ofstream out (binFile, std::ios::binary);
+            VSTScanner::outputBinaryCatalog (large, out);
+        }
+        bench.run ("bin/map-and-find-1000-of-100k", "lookups", 20, [&] () {
+            const VSTScanner::BinaryCatalogView view (binFile.string ());
+            size_t found = 0;
+            for (size_t i = 0; i < large.size (); i += large.size () / 1000)
+                found += view.findCid (large[i].cid) != VSTScanner::BinaryCatalogView::npos;
+            return found;
+        });
+        bench.run ("bin/load-100k", "plugins", 5, [&] () {
+            return VSTScanner::loadCatalogFile (binFile.string ()).size ();
+        });
+        fs::remove (binFile);
+
+        // Merging at company scale: 100k incoming records into a 100k catalog. Matched on
+        // CID, about three quarters of them replace an existing entry.
+        const auto largeIncoming = syntheticCatalog (100000, 4);
+        bench.run ("merge/100k-into-100k", "plugins", 5, [&] () {
+            VSTScanner::MergeOptions options;
+            options.policy = VSTScanner::MergePolicy::replaceWithNewer;
+            options.matchCid = true;
+            return VSTScanner::mergePlugins (large, largeIncoming, options).size ();
+        });
+    }
+
+    // Escaping alone: 64 MiB of paths and names with no character that needs an escape, and
+    // the same with a quote or control character every 64 bytes.
+    {
+        std::mt19937_64 rng (7);
+        const std::string alphabet = "abcdefghijklmnopqrstuvwxyz/ ._-ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+        std::string clean (64u << 20, '\0');
+        for (auto& c : clean)
+            c = alphabet[rng () % alphabet.size ()];
+        std::string dirty = clean;
+        for (size_t i = 63; i < dirty.size (); i += 64)
+            dirty[i] = (i / 64) % 2 ? '"' : '\x01';
+
+        bench.run ("json/escape-clean-64MiB", "MiB", 20, [&] () {
+            return VSTScanner::escapeJSONString (clean).size () >> 20;
+        });
+        bench.run ("json/escape-dirty-64MiB", "MiB", 20, [&] () {
+            VSTScanner::escapeJSONString (dirty);
+            return size_t (64);
+        });
+    }
+
+    // Includes copying both inputs, since mergePlugins consumes them.
+    const auto incoming = syntheticCatalog (20000, 2);
+    bench.run ("merge/20k-into-20k", "plugins", 10, [&] () {
+        VSTScanner::MergeOptions options;
+        options.policy = VSTScanner::MergePolicy::replaceWithNewer;
+        options.matchCid = true;
+        return VSTScanner::mergePlugins (catalog, incoming, options).size ();
+    });
+}
+
+void printUsage (const char* argv0)
+{
+    std::cerr << "Usage: " << argv0 << " [options]" << std::endl;
+    std::cerr << "Options:" << std::endl;
+    std::cerr << "  --fixtures <dir>     Where to generate the fixture tree (default: temp dir)"
+              << std::endl;
+    std::cerr << "  --generate <dir>     Only generate the fixture tree, then exit" << std::endl;
+    std::cerr << "  --scale <n>          Multiply the number of fast bundles (default: 1)"
+              << std::endl;
+    std::cerr << "  --filter <text>      Run only benchmarks whose name contains <text>"
+              << std::endl;
+    std::cerr << "  --iterations <n>     Cap iterations per benchmark (default: per benchmark)"
+              << std::endl;
+    std::cerr << "  --json               Print results as JSON instead of a table" << std::endl;
+    std::cerr << "  --keep               Keep the generated fixture tree" << std::endl;
+}
+
+} // anonymous
+
+//------------------------------------------------------------------------
+int main (int argc, char* argv[])
+{
+    fs::path fixtures = fs::temp_directory_path () / "vst_scanner_bench_fixtures";
+    std::string filter;
+    unsigned iterations = 1000;
+    unsigned scale = 1;
+    bool generateOnly = false;
+    bool json = false;
+    bool keep = false;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if ((arg == "--fixtures" || arg == "--generate") && i + 1 < argc)
+        {
+            fixtures = argv[++i];
+            generateOnly = arg == "--generate";
+            keep = keep || generateOnly;
+        }
+        else if (arg == "--scale" && i + 1 < argc)
+        {
+            scale = (std::max) (1u, static_cast<unsigned> (std::stoul (argv[++i])));
+        }
+        else if (arg == "--filter" && i + 1 < argc)
+        {
+            filter = argv[++i];
+        }
+        else if (arg == "--iterations" && i + 1 < argc)
+        {
+            iterations = static_cast<unsigned> (std::stoul (argv[++i]));
+        }
+        else if (arg == "--json")
+        {
+            json = true;
+        }
+        else if (arg == "--keep")
+        {
+            keep = true;
+        }
+        else
+        {
+            printUsage (argv[0]);
+            return arg == "-h" || arg == "--help" ? 0 : 1;
+        }
+    }
+
+    try
+    {
+        std::cerr << "Generating fixtures in " << fixtures.string () << std::endl;
+        generateFixtures (fixtures, scale);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: Could not generate fixtures: " << e.what () << std::endl;
+        return 1;
+    }
+    if (generateOnly)
+        return 0;
+
+    // Plugins and the scanner's own progress lines stay off the result output.
+    std::ofstream discard ("/dev/null");
+    VSTScanner::setLogStream (discard);
+
+    BenchRunner bench (filter, iterations);
+    runBenchmarks (bench, fixtures);
+    if (json)
+        bench.writeJSON (std::cout);
+    else
+        bench.writeTable (std::cout);
+
+    if (!keep)
+    {
+        std::error_code ec;
+        fs::remove_all (fixtures, ec);
+    }
+
+    // Abandoned in-process loads would otherwise block exit.
+    std::cout.flush ();
+    std::_Exit (bench.failed () ? 1 : 0);
+}
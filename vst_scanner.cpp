@@ -2,1037 +2,179 @@
 // VST Scanner
 // Description: Scans for VST plugins and outputs information to JSON
 //-----------------------------------------------------------------------------
+//
+// Command-line front end over the vst_scanner_core library (vst_scanner.h).
 
-#include "vst3sdk/public.sdk/source/vst/hosting/module.h"
-#include "vst3sdk/pluginterfaces/base/fplatform.h"
-#include <algorithm>
+#include "vst_scanner.h"
+#include <atomic>
+#include <cctype>
 #include <chrono>
-#include <cstdio>
 #include <cstdlib>
-#include <cstring>
 #include <filesystem>
 #include <fstream>
-#include <future>
 #include <iostream>
-#include <mutex>
-#include <sstream>
+#include <memory>
 #include <string>
-#include <unordered_set>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 
-#if SMTG_OS_WINDOWS
-#ifndef NOMINMAX
-#define NOMINMAX
+#if SMTG_OS_LINUX || SMTG_OS_MACOS
+#include <signal.h>
 #endif
-#include <windows.h>
-#endif
-
-//------------------------------------------------------------------------
-namespace VSTScanner {
-
-//------------------------------------------------------------------------
-struct PluginInfo {
-    std::string path;
-    std::string name;
-    std::string vendor;
-    std::string version;
-    std::vector<std::string> categories;
-    std::string cid;
-    std::string sdkVersion;
-    int32_t cardinality {0};
-    uint32_t flags {0};
-    bool isValid {false};
-    bool missingLicense {false};
-    bool loadFailed {false};
-    bool loadTimedOut {false};
-    std::string errorMessage;
-    std::string scanSource; // "factory" or "skipped"
-};
-
-//------------------------------------------------------------------------
-struct ScanOptions {
-    bool quiet {false};
-    unsigned factoryLoadTimeoutSec {5};
-    unsigned protectedPluginTimeoutSec {2};
-    bool skipFactoryLoad {false};
-    bool fastLicenseSkip {true};
-    bool isolateFactoryLoad {false};
-};
-
-//------------------------------------------------------------------------
-std::string toLowerAscii (std::string value)
-{
-    for (char& c : value)
-    {
-        if (c >= 'A' && c <= 'Z')
-            c = static_cast<char> (c - 'A' + 'a');
-    }
-    return value;
-}
-
-bool stringContainsInsensitive (const std::string& haystack, const std::string& needle)
-{
-    const auto h = toLowerAscii (haystack);
-    const auto n = toLowerAscii (needle);
-    return h.find (n) != std::string::npos;
-}
-
-bool isLikelyLicenseError (const std::string& errorMessage)
-{
-    static const char* keywords[] = {
-        "ilok",
-        "pace",
-        "license",
-        "licence",
-        "activation",
-        "not authorized",
-        "unauthorized",
-        "0x715",
-        "cannot be found",
-        "reinstall",
-        "noauthorizedlicenses",
-        "authorization required",
-        "licensedaemon",
-        nullptr,
-    };
-
-    for (const char** kw = keywords; *kw != nullptr; ++kw)
-    {
-        if (stringContainsInsensitive (errorMessage, *kw))
-            return true;
-    }
-    return false;
-}
-
-void classifyPluginFailure (PluginInfo& info)
-{
-    if (info.isValid)
-        return;
-
-    if (stringContainsInsensitive (info.errorMessage, "timed out"))
-    {
-        info.loadTimedOut = true;
-        info.loadFailed = true;
-        return;
-    }
-
-    if (isLikelyLicenseError (info.errorMessage))
-    {
-        info.missingLicense = true;
-        if (info.errorMessage.empty ())
-            info.errorMessage = "Missing or invalid license (iLok/PACE)";
-        return;
-    }
-
-    info.loadFailed = true;
-}
-
-//------------------------------------------------------------------------
-namespace {
-
-std::ostream& logOut = std::cout;
-std::mutex logMutex;
-
-void logLine (const std::string& msg)
-{
-    std::lock_guard<std::mutex> lock (logMutex);
-    logOut << msg << std::endl;
-    logOut.flush ();
-}
-
-bool dllNameSuggestsLicenseWrapper (const std::string& fileName)
-{
-    const auto lower = toLowerAscii (fileName);
-    return lower.find ("pace") != std::string::npos || lower.find ("ilok") != std::string::npos ||
-           lower.find ("wraptool") != std::string::npos ||
-           lower.find ("pacefusion") != std::string::npos ||
-           lower.find ("paceeden") != std::string::npos;
-}
-
-bool bundleUsesLicenseWrapper (const std::filesystem::path& modulePath)
-{
-    std::error_code ec;
-    if (!std::filesystem::is_directory (modulePath, ec))
-        return false;
-
-    const auto contents = modulePath / "Contents";
-    if (!std::filesystem::exists (contents, ec))
-        return false;
-
-    for (const auto& archEntry : std::filesystem::directory_iterator (contents, ec))
-    {
-        if (ec || !archEntry.is_directory (ec))
-            continue;
-
-        for (const auto& fileEntry :
-             std::filesystem::directory_iterator (archEntry.path (), ec))
-        {
-            if (ec || !fileEntry.is_regular_file (ec))
-                continue;
-
-            if (fileEntry.path ().extension () == ".dll" &&
-                dllNameSuggestsLicenseWrapper (fileEntry.path ().filename ().string ()))
-                return true;
-        }
-    }
-
-    return false;
-}
-
-bool bufferContainsInsensitive (const char* data, size_t size, const char* needle)
-{
-    const size_t nlen = std::strlen (needle);
-    if (nlen == 0 || size < nlen)
-        return false;
-
-    for (size_t i = 0; i <= size - nlen; ++i)
-    {
-        bool match = true;
-        for (size_t j = 0; j < nlen; ++j)
-        {
-            auto c = static_cast<unsigned char> (data[i + j]);
-            auto t = static_cast<unsigned char> (needle[j]);
-            if (c >= 'A' && c <= 'Z')
-                c = static_cast<unsigned char> (c - 'A' + 'a');
-            if (t >= 'A' && t <= 'Z')
-                t = static_cast<unsigned char> (t - 'A' + 'a');
-            if (c != t)
-            {
-                match = false;
-                break;
-            }
-        }
-        if (match)
-            return true;
-    }
-    return false;
-}
-
-bool binaryChunkHasLicenseMarker (const char* data, size_t size)
-{
-    static const char* markers[] = {
-        "pacefusion",
-        "paceeden",
-        "wraptool",
-        "ilok",
-        "noauthorizedlicensesfound",
-        "authorization required",
-        "licensedaemon",
-        nullptr,
-    };
-
-    for (const char** m = markers; *m != nullptr; ++m)
-    {
-        if (bufferContainsInsensitive (data, size, *m))
-            return true;
-    }
-    return false;
-}
-
-using BinaryMarkerCheck = bool (*) (const char* data, size_t size);
-
-bool scanFileRangeForMarkers (std::ifstream& file, size_t offset, size_t length,
-                              BinaryMarkerCheck check)
-{
-    file.clear ();
-    file.seekg (static_cast<std::streamoff> (offset), std::ios::beg);
-    if (!file)
-        return false;
-
-    constexpr size_t kChunkSize = 256 * 1024;
-    constexpr size_t kOverlap = 64;
-    std::vector<char> buffer (kChunkSize);
-    std::vector<char> carry;
-    size_t remaining = length;
-
-    while (remaining > 0 && file)
-    {
-        const auto toRead = (std::min) (kChunkSize, remaining);
-        file.read (buffer.data (), static_cast<std::streamsize> (toRead));
-        const auto bytesRead = static_cast<size_t> (file.gcount ());
-        if (bytesRead == 0)
-            break;
-
-        remaining -= bytesRead;
-
-        std::vector<char> chunk;
-        chunk.reserve (carry.size () + bytesRead);
-        chunk.insert (chunk.end (), carry.begin (), carry.end ());
-        chunk.insert (chunk.end (), buffer.data (), buffer.data () + bytesRead);
-
-        if (check (chunk.data (), chunk.size ()))
-            return true;
-
-        if (chunk.size () > kOverlap)
-        {
-            carry.assign (chunk.end () - static_cast<ptrdiff_t> (kOverlap), chunk.end ());
-        }
-        else
-        {
-            carry = std::move (chunk);
-        }
-    }
-
-    return false;
-}
-
-bool binaryFileHasMarkers (const std::filesystem::path& filePath, BinaryMarkerCheck check)
-{
-    std::error_code ec;
-    const auto fileSize = std::filesystem::file_size (filePath, ec);
-    if (ec || fileSize == 0)
-        return false;
-
-    std::ifstream file (filePath, std::ios::binary);
-    if (!file)
-        return false;
-
-    constexpr size_t kHeadScan = 4 * 1024 * 1024;
-    constexpr size_t kMidOffset = 20 * 1024 * 1024;
-    constexpr size_t kMidScan = 8 * 1024 * 1024;
-    constexpr size_t kTailScan = 2 * 1024 * 1024;
-
-    if (scanFileRangeForMarkers (file, 0, (std::min) (fileSize, kHeadScan), check))
-        return true;
-
-    if (fileSize > kMidOffset &&
-        scanFileRangeForMarkers (file, kMidOffset, (std::min) (kMidScan, fileSize - kMidOffset),
-                                 check))
-        return true;
-
-    if (fileSize > kTailScan &&
-        scanFileRangeForMarkers (file, fileSize - kTailScan, kTailScan, check))
-        return true;
-
-    return false;
-}
-
-bool monolithicModuleHasLicenseMarkers (const std::filesystem::path& modulePath)
-{
-    return binaryFileHasMarkers (modulePath, binaryChunkHasLicenseMarker);
-}
-
-bool pathSuggestsHeadlessUnsafeVendor (const std::filesystem::path& modulePath)
-{
-    // Win32 APIs like MessageBeep/PlaySound appear in most plugin DLLs — do not scan for those.
-    // Known vendors that beep/hang on headless factory load (e.g. iZotope monolithic .vst3).
-    const auto lower = toLowerAscii (modulePath.string ());
-    return lower.find ("\\izotope\\") != std::string::npos;
-}
-
-bool pathHasVst3Extension (const std::filesystem::path& modulePath);
-bool moduleLikelyNeedsLicense (const std::filesystem::path& modulePath);
-
-bool moduleLikelyUnsafeFactoryLoad (const std::filesystem::path& modulePath)
-{
-    if (moduleLikelyNeedsLicense (modulePath))
-        return false;
-
-    return pathSuggestsHeadlessUnsafeVendor (modulePath);
-}
-
-bool pathHasVst3Extension (const std::filesystem::path& modulePath)
-{
-    return toLowerAscii (modulePath.extension ().string ()) == ".vst3";
-}
-
-bool moduleLikelyNeedsLicense (const std::filesystem::path& modulePath)
-{
-    if (bundleUsesLicenseWrapper (modulePath))
-        return true;
-
-    std::error_code ec;
-    if (std::filesystem::is_regular_file (modulePath, ec) && pathHasVst3Extension (modulePath))
-        return monolithicModuleHasLicenseMarkers (modulePath);
-
-    return false;
-}
-
-void logProgress (const ScanOptions& options, size_t index, size_t total,
-                  const std::string& path, const char* phase)
-{
-    if (options.quiet)
-        return;
-
-    std::ostringstream line;
-    line << "[" << index << "/" << total << "] " << phase << ": " << path;
-    logLine (line.str ());
-}
-
-void logPluginResult (const ScanOptions& options, const PluginInfo& info)
-{
-    if (options.quiet)
-        return;
-
-    if (info.isValid)
-    {
-        logLine ("  -> OK: " + info.name + " (" + info.vendor + ")");
-        return;
-    }
-
-    if (info.missingLicense)
-        logLine ("  -> missing license (skipped)");
-    else if (info.loadFailed && info.scanSource == "skipped")
-        logLine ("  -> failed (skipped)");
-    else if (info.loadTimedOut)
-        logLine ("  -> timed out");
-    else if (info.loadFailed)
-        logLine ("  -> failed: " + info.errorMessage);
-    else
-        logLine ("  -> failed: " + info.errorMessage);
-}
-
-//------------------------------------------------------------------------
-constexpr const char* kVstAudioEffectClassName = "Audio Module Class";
-
-bool isAudioEffectCategory (const std::string& category)
-{
-    return category == kVstAudioEffectClassName;
-}
-
-//------------------------------------------------------------------------
-#if SMTG_OS_WINDOWS
-constexpr const char* kVst3Extension = ".vst3";
-#elif SMTG_OS_MACOS
-constexpr const char* kVst3Extension = ".vst3";
-constexpr const char* kBundleExtension = ".bundle";
-#elif SMTG_OS_LINUX
-constexpr const char* kVst3Extension = ".vst3";
-constexpr const char* kSharedLibExtension = ".so";
-#endif
-
-//------------------------------------------------------------------------
-bool isVst3BundleDirectory (const std::filesystem::path& path)
-{
-    if (!std::filesystem::is_directory (path))
-        return false;
-
-    const auto ext = path.extension ().string ();
-#if SMTG_OS_MACOS
-    if (ext != kVst3Extension && ext != kBundleExtension)
-        return false;
-#else
-    if (ext != kVst3Extension)
-        return false;
-#endif
-    std::error_code ec;
-    return std::filesystem::exists (path / "Contents", ec);
-}
-
-//------------------------------------------------------------------------
-bool isCandidateModulePath (const std::filesystem::path& path)
-{
-    std::error_code ec;
-
-    if (isVst3BundleDirectory (path))
-        return true;
-
-#if SMTG_OS_WINDOWS
-    // Legacy / monolithic Windows VST3: single .vst3 file (DLL), not a bundle folder
-    if (std::filesystem::is_regular_file (path, ec) && path.extension () == kVst3Extension)
-        return true;
-#elif SMTG_OS_LINUX
-    if (std::filesystem::is_regular_file (path, ec) && path.extension () == kSharedLibExtension)
-        return true;
-#endif
-
-    return false;
-}
-
-//------------------------------------------------------------------------
-void findVSTFilesRecursive (const std::filesystem::path& directory,
-                            std::unordered_set<std::string>& seen,
-                            std::vector<std::string>& vstFiles)
-{
-    std::error_code ec;
-    std::filesystem::directory_options opts =
-        std::filesystem::directory_options::skip_permission_denied;
-
-    for (const auto& entry : std::filesystem::directory_iterator (directory, opts, ec))
-    {
-        if (ec)
-        {
-            ec.clear ();
-            continue;
-        }
-
-        const auto& path = entry.path ();
-
-        if (isCandidateModulePath (path))
-        {
-            const auto canonical = path.string ();
-            if (seen.insert (canonical).second)
-                vstFiles.push_back (canonical);
-            continue;
-        }
-
-        if (entry.is_directory (ec))
-            findVSTFilesRecursive (path, seen, vstFiles);
-    }
-}
-
-} // anonymous
-
-//------------------------------------------------------------------------
-std::vector<std::string> findVSTFiles (const std::string& directory)
-{
-    std::vector<std::string> vstFiles;
-    std::unordered_set<std::string> seen;
-
-    try
-    {
-        std::error_code ec;
-        if (!std::filesystem::exists (directory, ec))
-            return vstFiles;
-
-        findVSTFilesRecursive (std::filesystem::path (directory), seen, vstFiles);
-        std::sort (vstFiles.begin (), vstFiles.end ());
-    }
-    catch (const std::exception& e)
-    {
-        std::cerr << "Error scanning directory: " << e.what () << std::endl;
-    }
-
-    return vstFiles;
-}
-
-//------------------------------------------------------------------------
-namespace {
-
-void fillPluginInfoFromHostingClass (PluginInfo& info,
-                                     const VST3::Hosting::ClassInfo& classInfo)
-{
-    info.name = classInfo.name ();
-    info.vendor = classInfo.vendor ();
-    info.version = classInfo.version ();
-    info.categories = classInfo.subCategories ();
-    info.cid = classInfo.ID ().toString ();
-    info.sdkVersion = classInfo.sdkVersion ();
-    info.cardinality = classInfo.cardinality ();
-    info.flags = classInfo.classFlags ();
-    info.isValid = true;
-}
-
-} // anonymous
-
-//------------------------------------------------------------------------
-PluginInfo scanPluginFromFactory (const std::string& pluginPath)
-{
-    PluginInfo info;
-    info.path = pluginPath;
-    info.isValid = false;
-
-    try
-    {
-        std::string errorStr;
-        auto module = VST3::Hosting::Module::create (pluginPath, errorStr);
-
-        if (!module)
-        {
-            info.errorMessage = errorStr;
-            return info;
-        }
-
-        auto factory = module->getFactory ();
-        auto classInfos = factory.classInfos ();
-
-        if (classInfos.empty ())
-        {
-            info.errorMessage = "No plugin classes found";
-            return info;
-        }
-
-        for (const auto& classInfo : classInfos)
-        {
-            if (isAudioEffectCategory (classInfo.category ()))
-            {
-                fillPluginInfoFromHostingClass (info, classInfo);
-                info.scanSource = "factory";
-                return info;
-            }
-        }
-
-        fillPluginInfoFromHostingClass (info, classInfos[0]);
-        info.scanSource = "factory";
-    }
-    catch (const std::exception& e)
-    {
-        info.errorMessage = e.what ();
-    }
-    catch (...)
-    {
-        info.errorMessage = "Unknown exception while loading plugin";
-    }
-
-    return info;
-}
-
-//------------------------------------------------------------------------
-std::vector<PluginInfo> parseExistingJSON (const std::string& filename);
-
-//------------------------------------------------------------------------
-namespace {
-
-std::string quoteArg (const std::string& arg)
-{
-    std::string out = "\"";
-    for (char c : arg)
-    {
-        if (c == '\\' || c == '"')
-            out += '\\';
-        out += c;
-    }
-    out += "\"";
-    return out;
-}
-
-#if SMTG_OS_WINDOWS
-PluginInfo scanPluginFromFactoryIsolated (const std::string& pluginPath, unsigned timeoutSec)
-{
-    PluginInfo fallback;
-    fallback.path = pluginPath;
-    fallback.isValid = false;
-
-    char exePath[MAX_PATH] {};
-    if (GetModuleFileNameA (nullptr, exePath, MAX_PATH) == 0)
-    {
-        fallback.errorMessage = "Could not resolve scanner executable path";
-        return fallback;
-    }
-
-    const auto tempDir = std::filesystem::temp_directory_path ();
-    std::ostringstream tempName;
-    tempName << "vst_scan_worker_" << GetCurrentProcessId () << "_"
-             << std::chrono::steady_clock::now ().time_since_epoch ().count () << ".json";
-    const auto outPath = tempDir / tempName.str ();
-
-    std::ostringstream cmd;
-    SetEnvironmentVariableA ("VST_SCANNER_WORKER_PLUGIN", pluginPath.c_str ());
-    SetEnvironmentVariableA ("VST_SCANNER_WORKER_OUTPUT", outPath.string ().c_str ());
-
-    cmd << quoteArg (exePath) << " --worker-env -q";
-    std::string cmdStr = cmd.str ();
-    std::vector<char> cmdBuf (cmdStr.begin (), cmdStr.end ());
-    cmdBuf.push_back ('\0');
-
-    STARTUPINFOA si {};
-    si.cb = sizeof (si);
-    si.dwFlags = STARTF_USESHOWWINDOW;
-    si.wShowWindow = SW_HIDE;
-
-    PROCESS_INFORMATION pi {};
-
-    if (!CreateProcessA (nullptr, cmdBuf.data (), nullptr, nullptr, FALSE, CREATE_NO_WINDOW,
-                         nullptr, nullptr, &si, &pi))
-    {
-        fallback.errorMessage = "Failed to start isolated plugin scan worker";
-        return fallback;
-    }
-
-    const DWORD timeoutMs = timeoutSec * 1000u;
-    const DWORD waitResult = WaitForSingleObject (pi.hProcess, timeoutMs);
-
-    if (waitResult == WAIT_TIMEOUT)
-    {
-        TerminateProcess (pi.hProcess, 1);
-        CloseHandle (pi.hProcess);
-        CloseHandle (pi.hThread);
-        std::error_code ec;
-        std::filesystem::remove (outPath, ec);
-        fallback.errorMessage =
-            "Timed out loading plugin (hung initializer or modal UI)";
-        fallback.loadTimedOut = true;
-        classifyPluginFailure (fallback);
-        return fallback;
-    }
-
-    DWORD exitCode = 1;
-    GetExitCodeProcess (pi.hProcess, &exitCode);
-    CloseHandle (pi.hProcess);
-    CloseHandle (pi.hThread);
-
-    std::vector<PluginInfo> parsed;
-    std::error_code ec;
-    for (int attempt = 0; attempt < 20; ++attempt)
-    {
-        if (std::filesystem::exists (outPath, ec))
-        {
-            parsed = VSTScanner::parseExistingJSON (outPath.string ());
-            if (!parsed.empty ())
-                break;
-        }
-        Sleep (25);
-    }
-
-    std::filesystem::remove (outPath, ec);
-
-    if (!parsed.empty ())
-        return parsed.front ();
-
-    if (!std::filesystem::exists (outPath, ec))
-    {
-        std::ostringstream msg;
-        msg << "Isolated worker exited without result (exit code " << exitCode
-            << "; plugin may have crashed on load)";
-        fallback.errorMessage = msg.str ();
-    }
-    else
-    {
-        fallback.errorMessage = "Could not parse worker scan result (exit code " +
-                               std::to_string (exitCode) + ")";
-    }
-    classifyPluginFailure (fallback);
-    return fallback;
-}
-#endif
-
-PluginInfo scanPluginFromFactoryWithTimeout (const std::string& pluginPath, unsigned timeoutSec)
-{
-    PluginInfo info;
-    info.path = pluginPath;
-    info.isValid = false;
-
-    auto future = std::async (std::launch::async,
-                              [&] () { return scanPluginFromFactory (pluginPath); });
-
-    if (future.wait_for (std::chrono::seconds (timeoutSec)) == std::future_status::timeout)
-    {
-        info.errorMessage = "Timed out loading plugin";
-        return info;
-    }
-
-    return future.get ();
-}
-
-PluginInfo loadPluginViaFactory (const std::string& pluginPath, const ScanOptions& options)
-{
-    PluginInfo info;
-    info.path = pluginPath;
-
-    if (options.fastLicenseSkip && moduleLikelyNeedsLicense (pluginPath))
-    {
-        info.isValid = false;
-        info.missingLicense = true;
-        info.scanSource = "skipped";
-        info.errorMessage = "License protection detected; DLL load skipped";
-        return info;
-    }
-
-    if (options.fastLicenseSkip && moduleLikelyUnsafeFactoryLoad (pluginPath))
-    {
-        info.isValid = false;
-        info.loadFailed = true;
-        info.scanSource = "skipped";
-        info.errorMessage =
-            "Factory load skipped (plugin alerts or blocks headless scan, e.g. iZotope)";
-        return info;
-    }
-
-    unsigned timeoutSec = options.factoryLoadTimeoutSec;
-    if (moduleLikelyNeedsLicense (pluginPath))
-        timeoutSec = (std::min) (timeoutSec, options.protectedPluginTimeoutSec);
-
-#if SMTG_OS_WINDOWS
-    if (options.isolateFactoryLoad)
-        info = scanPluginFromFactoryIsolated (pluginPath, timeoutSec);
-    else
-#endif
-    if (timeoutSec > 0)
-        info = scanPluginFromFactoryWithTimeout (pluginPath, timeoutSec);
-    else
-        info = scanPluginFromFactory (pluginPath);
-
-    classifyPluginFailure (info);
-    return info;
-}
-
-} // anonymous
-
-//------------------------------------------------------------------------
-std::vector<PluginInfo> scanPlugins (const std::vector<std::string>& paths,
-                                     const ScanOptions& options)
-{
-    std::vector<PluginInfo> results (paths.size ());
-    const size_t total = paths.size ();
-
-    for (size_t i = 0; i < paths.size (); ++i)
-    {
-        logProgress (options, i + 1, total, paths[i], "scanning");
-
-        if (options.skipFactoryLoad)
-        {
-            PluginInfo info;
-            info.path = paths[i];
-            info.loadFailed = true;
-            info.errorMessage = "Factory load skipped (--no-factory)";
-            results[i] = std::move (info);
-        }
-        else
-        {
-            results[i] = loadPluginViaFactory (paths[i], options);
-        }
-
-        logPluginResult (options, results[i]);
-    }
-
-    return results;
-}
-
-//------------------------------------------------------------------------
-std::string escapeJSONString (const std::string& input)
-{
-    std::string result;
-    result.reserve (input.length ());
-
-    for (char c : input)
-    {
-        switch (c)
-        {
-            case '\\': result += "\\\\"; break;
-            case '\"': result += "\\\""; break;
-            case '\b': result += "\\b"; break;
-            case '\f': result += "\\f"; break;
-            case '\n': result += "\\n"; break;
-            case '\r': result += "\\r"; break;
-            case '\t': result += "\\t"; break;
-            default: result += c; break;
-        }
-    }
-
-    return result;
-}
-
-//------------------------------------------------------------------------
-void outputJSON (const std::vector<PluginInfo>& plugins, std::ostream& out)
-{
-    out << "{\n";
-    out << "  \"scanTime\": \""
-        << std::chrono::system_clock::now ().time_since_epoch ().count () << "\",\n";
-    out << "  \"totalPlugins\": " << plugins.size () << ",\n";
-    out << "  \"validPlugins\": "
-        << std::count_if (plugins.begin (), plugins.end (),
-                          [] (const PluginInfo& p) { return p.isValid; })
-        << ",\n";
-    out << "  \"plugins\": [\n";
-
-    for (size_t i = 0; i < plugins.size (); ++i)
-    {
-        const auto& plugin = plugins[i];
-        out << "    {\n";
-        out << "      \"path\": \"" << escapeJSONString (plugin.path) << "\",\n";
-        out << "      \"isValid\": " << (plugin.isValid ? "true" : "false") << ",\n";
-
-        if (plugin.isValid)
-        {
-            if (!plugin.scanSource.empty ())
-                out << "      \"scanSource\": \"" << escapeJSONString (plugin.scanSource)
-                    << "\",\n";
-            out << "      \"name\": \"" << escapeJSONString (plugin.name) << "\",\n";
-            out << "      \"vendor\": \"" << escapeJSONString (plugin.vendor) << "\",\n";
-            out << "      \"version\": \"" << escapeJSONString (plugin.version) << "\",\n";
-            out << "      \"cid\": \"" << escapeJSONString (plugin.cid) << "\",\n";
-            out << "      \"sdkVersion\": \"" << escapeJSONString (plugin.sdkVersion)
-                << "\",\n";
-            out << "      \"cardinality\": " << plugin.cardinality << ",\n";
-            out << "      \"flags\": " << plugin.flags << ",\n";
-
-            out << "      \"categories\": [";
-            for (size_t j = 0; j < plugin.categories.size (); ++j)
-            {
-                if (j > 0)
-                    out << ", ";
-                out << "\"" << escapeJSONString (plugin.categories[j]) << "\"";
-            }
-            out << "]\n";
-        }
-        else
-        {
-            if (!plugin.scanSource.empty ())
-                out << "      \"scanSource\": \"" << escapeJSONString (plugin.scanSource)
-                    << "\",\n";
-            out << "      \"missingLicense\": " << (plugin.missingLicense ? "true" : "false")
-                << ",\n";
-            out << "      \"failed\": " << (plugin.loadFailed ? "true" : "false") << ",\n";
-            out << "      \"loadTimedOut\": " << (plugin.loadTimedOut ? "true" : "false")
-                << ",\n";
-            out << "      \"error\": \"" << escapeJSONString (plugin.errorMessage) << "\"\n";
-        }
-
-        out << "    }";
-        if (i < plugins.size () - 1)
-            out << ",";
-        out << "\n";
-    }
-
-    out << "  ]\n";
-    out << "}\n";
-}
-
-//------------------------------------------------------------------------
-} // namespace VSTScanner
-
-//------------------------------------------------------------------------
-namespace VSTScanner {
-
-//------------------------------------------------------------------------
-std::vector<PluginInfo> parseExistingJSON (const std::string& filename)
-{
-    std::vector<PluginInfo> existingPlugins;
-    std::ifstream file (filename);
-
-    if (!file.is_open ())
-        return existingPlugins;
-
-    std::string line;
-    bool inPluginsArray = false;
-    bool inPluginObject = false;
-    PluginInfo currentPlugin;
-
-    while (std::getline (file, line))
-    {
-        if (line.empty () || line.find ("//") == 0)
-            continue;
-
-        if (line.find ("\"plugins\"") != std::string::npos && line.find ("[") != std::string::npos)
-        {
-            inPluginsArray = true;
-            continue;
-        }
-
-        if (inPluginsArray && line.find ("]") != std::string::npos)
-        {
-            inPluginsArray = false;
-            break;
-        }
-
-        if (!inPluginsArray)
-            continue;
-
-        if (line.find ("{") != std::string::npos && inPluginsArray)
-        {
-            inPluginObject = true;
-            currentPlugin = PluginInfo ();
-            continue;
-        }
-
-        if (!inPluginObject)
-            continue;
-
-        std::string trimmed = line;
-        trimmed.erase (0, trimmed.find_first_not_of (" \t"));
-        trimmed.erase (trimmed.find_last_not_of (" \t,") + 1);
-
-        if (trimmed == "}" || trimmed == "},")
-        {
-            inPluginObject = false;
-            existingPlugins.push_back (currentPlugin);
-            continue;
-        }
-
-        auto extractQuoted = [&] (const std::string& key) -> std::string
-        {
-            if (trimmed.find (key) != 0)
-                return {};
-            size_t start = trimmed.find ('"') + 1;
-            size_t end = trimmed.find_last_of ('"');
-            if (start < end)
-                return trimmed.substr (start, end - start);
-            return {};
-        };
 
-        if (trimmed.find ("\"path\"") == 0)
-            currentPlugin.path = extractQuoted ("\"path\"");
-        else if (trimmed.find ("\"isValid\"") == 0)
-            currentPlugin.isValid = (trimmed.find ("true") != std::string::npos);
-        else if (trimmed.find ("\"missingLicense\"") == 0)
-            currentPlugin.missingLicense = (trimmed.find ("true") != std::string::npos);
-        else if (trimmed.find ("\"failed\"") == 0)
-            currentPlugin.loadFailed = (trimmed.find ("true") != std::string::npos);
-        else if (trimmed.find ("\"loadTimedOut\"") == 0)
-            currentPlugin.loadTimedOut = (trimmed.find ("true") != std::string::npos);
-        else if (trimmed.find ("\"name\"") == 0)
-            currentPlugin.name = extractQuoted ("\"name\"");
-        else if (trimmed.find ("\"vendor\"") == 0)
-            currentPlugin.vendor = extractQuoted ("\"vendor\"");
-        else if (trimmed.find ("\"version\"") == 0)
-            currentPlugin.version = extractQuoted ("\"version\"");
-        else if (trimmed.find ("\"categories\"") == 0
-                 || trimmed.find ("\"subCategories\"") == 0)
-        {
-            currentPlugin.categories.clear ();
-            size_t pos = 0;
-            while ((pos = trimmed.find ('"', pos)) != std::string::npos)
-            {
-                size_t start = pos + 1;
-                size_t end = trimmed.find ('"', start);
-                if (end == std::string::npos)
-                    break;
-                std::string item = trimmed.substr (start, end - start);
-                if (item != "categories" && item != "subCategories")
-                    currentPlugin.categories.push_back (item);
-                pos = end + 1;
-            }
-        }
-        else if (trimmed.find ("\"cid\"") == 0)
-            currentPlugin.cid = extractQuoted ("\"cid\"");
-        else if (trimmed.find ("\"sdkVersion\"") == 0)
-            currentPlugin.sdkVersion = extractQuoted ("\"sdkVersion\"");
-        else if (trimmed.find ("\"cardinality\"") == 0)
-            currentPlugin.cardinality = std::stoi (trimmed.substr (trimmed.find (':') + 1));
-        else if (trimmed.find ("\"flags\"") == 0)
-            currentPlugin.flags = std::stoul (trimmed.substr (trimmed.find (':') + 1));
-        else if (trimmed.find ("\"error\"") == 0)
-            currentPlugin.errorMessage = extractQuoted ("\"error\"");
-    }
+//------------------------------------------------------------------------
+std::atomic<bool> stopRequested {false};
 
-    return existingPlugins;
+// SIGINT/SIGTERM handler for the long-running modes (--watch, --serve).
+void requestStop (int)
+{
+    stopRequested = true;
+#if SMTG_OS_LINUX
+    VSTScanner::stopWatching ();
+#endif
 }
 
 //------------------------------------------------------------------------
-std::vector<PluginInfo> mergePlugins (const std::vector<PluginInfo>& existing,
-                                      const std::vector<PluginInfo>& newPlugins)
+// Writes a finished catalog in the --format chosen (json or bin). Only JSON carries a profile.
+void writeCatalog (const std::vector<VSTScanner::PluginInfo>& catalog, const std::string& format,
+                   std::ostream& out, const VSTScanner::ScanProfile* profile = nullptr)
+{
+    if (format == "bin")
+        VSTScanner::outputBinaryCatalog (catalog, out);
+    else
+        VSTScanner::outputJSON (catalog, out, profile);
+}
+
+// Answers a --query request from a binary catalog file, in the reply format of --serve (no
+// generations: the file does not change). path and cid go through the file's hash indexes;
+// CIDs are stored as uppercase hex, so a lowercase one is tried uppercased too.
+bool queryBinaryCatalog (const VSTScanner::BinaryCatalogView& catalog,
+                         const std::string& request, std::ostream& out)
 {
-    std::vector<PluginInfo> merged = existing;
+    const auto space = request.find (' ');
+    const auto verb = request.substr (0, space);
+    const auto argument = space == std::string::npos ? std::string () : request.substr (space + 1);
 
-    for (const auto& newPlugin : newPlugins)
+    std::vector<size_t> hits;
+    if (verb == "path")
+        hits.push_back (catalog.findPath (argument));
+    else if (verb == "cid")
     {
-        bool exists = false;
-        for (const auto& existingPlugin : existing)
+        size_t hit = catalog.findCid (argument);
+        if (hit == VSTScanner::BinaryCatalogView::npos)
         {
-            if (existingPlugin.path == newPlugin.path)
-            {
-                exists = true;
-                break;
-            }
+            std::string upper = argument;
+            for (auto& c : upper)
+                c = static_cast<char> (std::toupper (static_cast<unsigned char> (c)));
+            hit = catalog.findCid (upper);
         }
-
-        if (!exists)
-            merged.push_back (newPlugin);
+        hits.push_back (hit);
+    }
+    else if (verb == "all")
+    {
+        for (size_t i = 0; i < catalog.size (); ++i)
+            hits.push_back (i);
+    }
+    else
+    {
+        out << "{\"type\": \"error\", \"message\": \"unknown query for a catalog file: "
+            << VSTScanner::escapeJSONString (verb) << "\"}\n";
+        return false;
     }
 
-    return merged;
+    size_t count = 0;
+    VSTScanner::NDJSONWriter writer (out);
+    for (const size_t i : hits)
+    {
+        if (i == VSTScanner::BinaryCatalogView::npos)
+            continue;
+        writer.write (catalog.plugin (i));
+        ++count;
+    }
+    out << "{\"type\": \"end\", \"count\": " << count << "}\n";
+    return true;
 }
 
-//------------------------------------------------------------------------
-} // namespace VSTScanner
+std::ios::openmode catalogOpenMode (const std::string& format)
+{
+    return format == "bin" ? std::ios::binary | std::ios::trunc : std::ios::trunc;
+}
 
 //------------------------------------------------------------------------
 void printUsage (const char* argv0)
 {
     std::cerr << "Usage: " << argv0 << " <directory_path> [options]" << std::endl;
+    std::cerr << "       " << argv0 << " --query <socket> <request>  (ask a --serve instance)"
+              << std::endl;
+    std::cerr << "       " << argv0 << " --query <catalog.bin> <request>  (path, cid or all)"
+              << std::endl;
+    std::cerr << "       " << argv0 << " --convert <catalog> [-o <file>] [--format <fmt>]"
+              << std::endl;
     std::cerr << "       " << argv0 << " --worker <plugin_path> -o <file.json>" << std::endl;
-    std::cerr << "       " << argv0 << " --worker-env  (internal; uses env vars)" << std::endl;
+    std::cerr << "       " << argv0 << " --worker-env  (internal; older hosts, uses env vars)" << std::endl;
     std::cerr << "Options:" << std::endl;
     std::cerr << "  -o <output_file.json>     Output to file (default: stdout)" << std::endl;
     std::cerr << "  -c <cumulative_file.json> Append to existing cumulative file" << std::endl;
+    std::cerr << "  --merge <policy>          With -c: keep-old (default), replace, keep-valid"
+              << std::endl;
+    std::cerr << "  --merge-cid               With -c: also treat equal CIDs as the same plugin"
+              << std::endl;
+    std::cerr << "  --format <json|ndjson|bin> json (default), one record per line (streamed), or"
+              << std::endl;
+    std::cerr << "                            a binary catalog that can be mapped (needs -o/-c)"
+              << std::endl;
     std::cerr << "  --timeout <seconds>       Per-plugin factory load timeout (default: 5)"
               << std::endl;
+    std::cerr << "  --walk-threads <n>        Directory discovery threads (default: one per core)"
+              << std::endl;
+    std::cerr << "  --cache <file>            Reuse results for unchanged modules across runs"
+              << std::endl;
+    std::cerr << "  --cache-retry <hours>     Reload cached failures after <hours> (0 = always,"
+              << std::endl;
+    std::cerr << "                            -1 = never; default: 24)" << std::endl;
     std::cerr << "  --try-license-load        Attempt DLL load for PACE/iLok bundles (slower)"
               << std::endl;
-    std::cerr << "  --no-isolate              Load plugins in-process (Windows only, risky)"
+    std::cerr << "  --no-binary-check         Load modules that fail the ELF pre-check (Linux)"
               << std::endl;
+    std::cerr << "  --isolate                 Load each plugin in a worker process (Windows, Linux)"
+              << std::endl;
+    std::cerr << "  --no-isolate              Load plugins in-process (risky)" << std::endl;
     std::cerr << "  --no-factory              List paths only; never load plugin DLLs"
               << std::endl;
+    std::cerr << "  --no-moduleinfo           Load bundles even when they ship moduleinfo.json"
+              << std::endl;
+    std::cerr << "  --verify-moduleinfo       Load them as well and check moduleinfo.json"
+              << std::endl;
+    std::cerr << "  --jobs <n>                Load <n> plugins in parallel (0 = one per core)"
+              << std::endl;
+    std::cerr << "  --max-inflight <n>        Per-worker cap on loaded modules (default: 4)"
+              << std::endl;
+    std::cerr << "  --max-abandoned <n>       Hung loads tolerated before skipping (default: 8)"
+              << std::endl;
+    std::cerr << "  --slow-lane <n>           Workers for modules that hung last run (default: 1;"
+              << std::endl;
+    std::cerr << "                            0 = scan them last)" << std::endl;
+    std::cerr << "  --input-order             Scan in discovery order, ignoring cache history"
+              << std::endl;
+    std::cerr << "  --budget <seconds>        Start no plugin after <seconds>; partial catalog"
+              << std::endl;
+    std::cerr << "                            (an existing journal is resumed)" << std::endl;
+    std::cerr << "  --journal <file>          Append each finished plugin to <file> as it completes"
+              << std::endl;
+    std::cerr << "  --resume                  Take results from the journal instead of rescanning"
+              << std::endl;
+    std::cerr << "  --profile                 Record per-phase timings; add them to the output"
+              << std::endl;
+    std::cerr << "  --trace <file.json>       Write a Chrome Trace Event timeline of the scan"
+              << std::endl;
+    std::cerr << "  --watch                   Keep running; rescan changed modules (Linux)"
+              << std::endl;
+    std::cerr << "  --watch-debounce <ms>     Quiet time before a watch rescan (default: 2000)"
+              << std::endl;
+    std::cerr << "  --serve <socket>          Keep running; answer catalog queries on a Unix socket"
+              << std::endl;
     std::cerr << "  -q, --quiet               Suppress per-plugin progress output" << std::endl;
     std::cerr << "  -h, --help                Show this help message" << std::endl;
 }
@@ -1050,8 +192,17 @@ int main (int argc, char* argv[])
     std::string outputFile;
     std::string cumulativeFile;
     std::string workerPlugin;
+    std::string outputFormat = "json";
     bool useCumulative = false;
+    unsigned walkThreads = 0;
     VSTScanner::ScanOptions scanOptions;
+    VSTScanner::MergeOptions mergeOptions;
+    VSTScanner::WatchOptions watchOptions;
+    bool watch = false;
+    bool profileScan = false;
+    std::string traceFile;
+    std::string serveSocket;
+    std::string convertInput;
 
     for (int i = 1; i < argc; ++i)
     {
@@ -1071,10 +222,87 @@ int main (int argc, char* argv[])
             cumulativeFile = argv[++i];
             useCumulative = true;
         }
+        else if (arg == "--merge" && i + 1 < argc)
+        {
+            const std::string policy = argv[++i];
+            if (policy == "keep-old")
+                mergeOptions.policy = VSTScanner::MergePolicy::keepOld;
+            else if (policy == "replace")
+                mergeOptions.policy = VSTScanner::MergePolicy::replaceWithNewer;
+            else if (policy == "keep-valid")
+                mergeOptions.policy = VSTScanner::MergePolicy::keepValidOverFailed;
+            else
+            {
+                std::cerr << "Unknown merge policy: " << policy << std::endl;
+                return 1;
+            }
+        }
+        else if (arg == "--merge-cid")
+        {
+            mergeOptions.matchCid = true;
+        }
+        else if (arg == "--format" && i + 1 < argc)
+        {
+            outputFormat = argv[++i];
+            if (outputFormat != "json" && outputFormat != "ndjson" && outputFormat != "bin")
+            {
+                std::cerr << "Unknown output format: " << outputFormat << std::endl;
+                return 1;
+            }
+        }
         else if (arg == "--timeout" && i + 1 < argc)
         {
             scanOptions.factoryLoadTimeoutSec = static_cast<unsigned> (std::stoul (argv[++i]));
         }
+        else if (arg == "--jobs" && i + 1 < argc)
+        {
+            scanOptions.jobs = static_cast<unsigned> (std::stoul (argv[++i]));
+        }
+        else if (arg == "--max-inflight" && i + 1 < argc)
+        {
+            scanOptions.maxInFlightLoadsPerWorker =
+                static_cast<unsigned> (std::stoul (argv[++i]));
+        }
+        else if (arg == "--max-abandoned" && i + 1 < argc)
+        {
+            scanOptions.maxAbandonedLoads = static_cast<unsigned> (std::stoul (argv[++i]));
+        }
+        else if (arg == "--slow-lane" && i + 1 < argc)
+        {
+            scanOptions.slowLaneJobs = static_cast<unsigned> (std::stoul (argv[++i]));
+        }
+        else if (arg == "--input-order")
+        {
+            scanOptions.prioritizeFromHistory = false;
+        }
+        else if (arg == "--budget" && i + 1 < argc)
+        {
+            scanOptions.budgetSec = static_cast<unsigned> (std::stoul (argv[++i]));
+        }
+        else if (arg == "--journal" && i + 1 < argc)
+        {
+            scanOptions.journalFile = argv[++i];
+        }
+        else if (arg == "--resume")
+        {
+            scanOptions.resumeJournal = true;
+        }
+        else if (arg == "--isolate")
+        {
+            scanOptions.isolateFactoryLoad = true;
+        }
+        else if (arg == "--walk-threads" && i + 1 < argc)
+        {
+            walkThreads = static_cast<unsigned> (std::stoul (argv[++i]));
+        }
+        else if (arg == "--cache" && i + 1 < argc)
+        {
+            scanOptions.cacheFile = argv[++i];
+        }
+        else if (arg == "--cache-retry" && i + 1 < argc)
+        {
+            scanOptions.cacheRetryFailedHours = std::stoi (argv[++i]);
+        }
         else if (arg == "--no-isolate")
         {
             scanOptions.isolateFactoryLoad = false;
@@ -1083,10 +311,22 @@ int main (int argc, char* argv[])
         {
             scanOptions.skipFactoryLoad = true;
         }
+        else if (arg == "--no-moduleinfo")
+        {
+            scanOptions.useModuleInfo = false;
+        }
+        else if (arg == "--verify-moduleinfo")
+        {
+            scanOptions.verifyModuleInfo = true;
+        }
         else if (arg == "--try-license-load")
         {
             scanOptions.fastLicenseSkip = false;
         }
+        else if (arg == "--no-binary-check")
+        {
+            scanOptions.checkModuleBinary = false;
+        }
         else if (arg == "--worker" && i + 1 < argc)
         {
             workerPlugin = argv[++i];
@@ -1098,6 +338,54 @@ int main (int argc, char* argv[])
             if (const char* o = std::getenv ("VST_SCANNER_WORKER_OUTPUT"))
                 outputFile = o;
         }
+        else if (arg == "--profile")
+        {
+            profileScan = true;
+        }
+        else if (arg == "--trace" && i + 1 < argc)
+        {
+            traceFile = argv[++i];
+        }
+        else if (arg == "--watch")
+        {
+            watch = true;
+        }
+        else if (arg == "--watch-debounce" && i + 1 < argc)
+        {
+            watchOptions.debounceMs = static_cast<unsigned> (std::stoul (argv[++i]));
+        }
+        else if (arg == "--convert" && i + 1 < argc)
+        {
+            convertInput = argv[++i];
+        }
+        else if (arg == "--serve" && i + 1 < argc)
+        {
+            serveSocket = argv[++i];
+        }
+        else if (arg == "--query" && i + 2 < argc)
+        {
+            const std::string socketPath = argv[++i];
+            std::string request = argv[++i];
+            while (++i < argc)
+                request += std::string (" ") + argv[i];
+
+            // A binary catalog is queried in place; anything else is a --serve socket.
+            const VSTScanner::BinaryCatalogView catalog (socketPath);
+            if (catalog.valid ())
+                return queryBinaryCatalog (catalog, request, std::cout) ? 0 : 1;
+#if SMTG_OS_LINUX || SMTG_OS_MACOS
+            if (!VSTScanner::queryCatalogServer (socketPath, request, std::cout))
+            {
+                std::cerr << "Error: No answer from " << socketPath << std::endl;
+                return 1;
+            }
+            return 0;
+#else
+            std::cerr << "Error: " << socketPath << " is not a binary catalog, and --serve "
+                      << "sockets are not supported on this platform" << std::endl;
+            return 1;
+#endif
+        }
         else if (arg == "-q" || arg == "--quiet")
         {
             scanOptions.quiet = true;
@@ -1136,6 +424,48 @@ int main (int argc, char* argv[])
         return 0;
     }
 
+    const bool binaryOutput = outputFormat == "bin";
+    if (binaryOutput && outputFile.empty () && !useCumulative)
+    {
+        std::cerr << "Error: --format bin needs an output file (-o or -c)" << std::endl;
+        return 1;
+    }
+
+    if (!convertInput.empty ())
+    {
+        std::error_code ec;
+        if (!std::filesystem::is_regular_file (convertInput, ec))
+        {
+            std::cerr << "Error: Cannot read catalog: " << convertInput << std::endl;
+            return 1;
+        }
+        const auto catalog = VSTScanner::loadCatalogFile (convertInput);
+
+        std::ofstream out;
+        if (!outputFile.empty ())
+        {
+            out.open (outputFile, catalogOpenMode (outputFormat));
+            if (!out.is_open ())
+            {
+                std::cerr << "Error: Could not open output file: " << outputFile << std::endl;
+                return 1;
+            }
+        }
+        std::ostream& target = outputFile.empty () ? std::cout : out;
+        if (outputFormat == "ndjson")
+        {
+            VSTScanner::NDJSONWriter writer (target);
+            for (const auto& plugin : catalog)
+                writer.write (plugin);
+            writer.writeSummary ();
+        }
+        else
+        {
+            writeCatalog (catalog, outputFormat, target);
+        }
+        return target.flush () ? 0 : 1;
+    }
+
     if (directory.empty ())
     {
         std::cerr << "Error: Directory path is required" << std::endl;
@@ -1148,80 +478,267 @@ int main (int argc, char* argv[])
         return 1;
     }
 
+    const bool streamNDJSON = outputFormat == "ndjson";
+    if (streamNDJSON && useCumulative)
+    {
+        std::cerr << "Error: Cannot use -c with --format ndjson" << std::endl;
+        return 1;
+    }
+
+#if !SMTG_OS_LINUX && !SMTG_OS_MACOS
+    if (!serveSocket.empty ())
+    {
+        std::cerr << "Error: --serve is not supported on this platform" << std::endl;
+        return 1;
+    }
+#endif
+    if (!serveSocket.empty () && streamNDJSON)
+    {
+        std::cerr << "Error: Cannot use --serve with --format ndjson" << std::endl;
+        return 1;
+    }
+
+    if (watch)
+    {
+#if SMTG_OS_LINUX
+        if (streamNDJSON || (outputFile.empty () && !useCumulative && serveSocket.empty ()))
+        {
+            std::cerr << "Error: --watch needs an output file (-o or -c) or --serve"
+                      << std::endl;
+            return 1;
+        }
+#else
+        std::cerr << "Error: --watch is only supported on Linux" << std::endl;
+        return 1;
+#endif
+    }
+
+    // A budgeted or resumed scan keeps its journal next to the output file by default. A
+    // budgeted scan also resumes a journal it finds (a completed run deletes its journal), so
+    // the same command line run again picks up where the last one stopped.
+    if (scanOptions.journalFile.empty () &&
+        (scanOptions.resumeJournal || scanOptions.budgetSec > 0))
+    {
+        const std::string& target = useCumulative ? cumulativeFile : outputFile;
+        if (!target.empty ())
+            scanOptions.journalFile = target + ".journal";
+    }
+    if (scanOptions.budgetSec > 0 && !scanOptions.journalFile.empty ())
+    {
+        std::error_code ec;
+        if (std::filesystem::is_regular_file (scanOptions.journalFile, ec))
+            scanOptions.resumeJournal = true;
+    }
+    if (scanOptions.resumeJournal && scanOptions.journalFile.empty ())
+    {
+        std::cerr << "Error: --resume needs --journal <file> or an output file (-o or -c)"
+                  << std::endl;
+        return 1;
+    }
+
+    // Keep stdout machine-readable when it carries NDJSON records.
+    std::ostream& status = (streamNDJSON && outputFile.empty ()) ? std::cerr : std::cout;
+    VSTScanner::setLogStream (status);
+
     const auto scanStart = std::chrono::steady_clock::now ();
 
     if (!scanOptions.quiet)
-        std::cout << "Scanning directory: " << directory << std::endl;
+        status << "Scanning directory: " << directory << std::endl;
+
+    // Scan workers add their own tracks; everything main does between them goes on "main".
+    std::unique_ptr<VSTScanner::ScanTrace> trace;
+    VSTScanner::ScanTrace::Track* mainTrack = nullptr;
+    if (!traceFile.empty ())
+    {
+        trace = std::make_unique<VSTScanner::ScanTrace> ();
+        mainTrack = &trace->addTrack ("main");
+        scanOptions.trace = trace.get ();
+    }
+    const auto traceMain = [mainTrack] (const char* name,
+                                        std::chrono::steady_clock::time_point started) {
+        if (mainTrack)
+            mainTrack->span (name, started, std::chrono::steady_clock::now ());
+    };
 
     std::vector<VSTScanner::PluginInfo> existingPlugins;
     if (useCumulative && !cumulativeFile.empty ())
     {
         if (!scanOptions.quiet)
-            std::cout << "Loading existing plugins from: " << cumulativeFile << std::endl;
-        existingPlugins = VSTScanner::parseExistingJSON (cumulativeFile);
+            status << "Loading existing plugins from: " << cumulativeFile << std::endl;
+        const auto loadStart = std::chrono::steady_clock::now ();
+        existingPlugins = VSTScanner::loadCatalogFile (cumulativeFile);
+        traceMain ("load catalog", loadStart);
         if (!scanOptions.quiet)
-            std::cout << "Found " << existingPlugins.size () << " existing plugins" << std::endl;
+            status << "Found " << existingPlugins.size () << " existing plugins" << std::endl;
     }
 
-    auto vstFiles = VSTScanner::findVSTFiles (directory);
-    if (!scanOptions.quiet)
-        std::cout << "Found " << vstFiles.size () << " VST modules" << std::endl;
+    VSTScanner::ScanProfile scanProfile;
+    VSTScanner::ScanProfile* profile = profileScan ? &scanProfile : nullptr;
+
+    const auto discoveryStart = std::chrono::steady_clock::now ();
+    auto modules = VSTScanner::discoverModules (directory, walkThreads);
+    traceMain ("discovery", discoveryStart);
+    if (profile)
+        profile->setDiscoveryMs (std::chrono::duration<double, std::milli> (
+                                     std::chrono::steady_clock::now () - discoveryStart)
+                                     .count ());
+
+    // Modules are scanned by their primary path; results get the other paths back as aliases.
+    std::vector<std::string> vstFiles;
+    std::unordered_map<std::string, std::vector<std::string>> aliases;
+    size_t aliasCount = 0;
+    for (auto& module : modules)
+    {
+        vstFiles.push_back (module.path);
+        if (!module.aliases.empty ())
+        {
+            aliasCount += module.aliases.size ();
+            aliases.emplace (std::move (module.path), std::move (module.aliases));
+        }
+    }
+    modules.clear ();
+    const auto attachAliases = [&aliases] (VSTScanner::PluginInfo& info) {
+        const auto found = aliases.find (info.path);
+        if (found != aliases.end ())
+            info.aliases = found->second;
+    };
 
-    auto newPlugins = VSTScanner::scanPlugins (vstFiles, scanOptions);
+    if (!scanOptions.quiet)
+    {
+        status << "Found " << vstFiles.size () << " VST modules";
+        if (aliasCount > 0)
+            status << " (" << aliasCount << " duplicate paths through links collapsed)";
+        status << std::endl;
+    }
 
+    VSTScanner::ScanTotals totals;
+    size_t scannedCount = 0; // fewer than vstFiles when --budget ran out
     std::vector<VSTScanner::PluginInfo> finalPlugins;
-    if (useCumulative)
+    std::ofstream outFile;
+    const std::string outputFileName = useCumulative ? cumulativeFile : outputFile;
+
+    if (streamNDJSON)
     {
-        finalPlugins = VSTScanner::mergePlugins (existingPlugins, newPlugins);
-        if (!scanOptions.quiet)
+        if (!outputFileName.empty ())
         {
-            std::cout << "Merged " << newPlugins.size () << " new plugins with "
-                      << existingPlugins.size () << " existing plugins. Total: "
-                      << finalPlugins.size () << std::endl;
+            outFile.open (outputFileName);
+            if (!outFile.is_open ())
+            {
+                std::cerr << "Error: Could not open output file: " << outputFileName << std::endl;
+                return 1;
+            }
         }
+
+        VSTScanner::NDJSONWriter writer (outputFileName.empty () ? std::cout : outFile, profile);
+        const auto loadStart = std::chrono::steady_clock::now ();
+        VSTScanner::scanPlugins (vstFiles, scanOptions,
+                                 [&] (size_t, VSTScanner::PluginInfo&& info) {
+                                     attachAliases (info);
+                                     writer.write (info);
+                                 });
+        if (profile)
+            profile->setScanMs (std::chrono::duration<double, std::milli> (
+                                    std::chrono::steady_clock::now () - loadStart)
+                                    .count ());
+        writer.writeSummary ();
+        totals = writer.totals ();
+        scannedCount = totals.total;
     }
     else
     {
-        finalPlugins = std::move (newPlugins);
+        const auto loadStart = std::chrono::steady_clock::now ();
+        auto newPlugins = VSTScanner::scanPlugins (vstFiles, scanOptions);
+        scannedCount = newPlugins.size ();
+        for (auto& p : newPlugins)
+            attachAliases (p);
+        if (profile)
+        {
+            profile->setScanMs (std::chrono::duration<double, std::milli> (
+                                    std::chrono::steady_clock::now () - loadStart)
+                                    .count ());
+            for (const auto& p : newPlugins)
+                profile->add (p.timings);
+        }
+
+        if (useCumulative)
+        {
+            const size_t newCount = newPlugins.size ();
+            const size_t existingCount = existingPlugins.size ();
+            const auto mergeStart = std::chrono::steady_clock::now ();
+            finalPlugins = VSTScanner::mergePlugins (std::move (existingPlugins),
+                                                     std::move (newPlugins), mergeOptions);
+            traceMain ("merge", mergeStart);
+            if (!scanOptions.quiet)
+            {
+                status << "Merged " << newCount << " new plugins with " << existingCount
+                       << " existing plugins. Total: " << finalPlugins.size () << std::endl;
+            }
+        }
+        else
+        {
+            finalPlugins = std::move (newPlugins);
+        }
+
+        for (const auto& p : finalPlugins)
+            totals.add (p);
     }
 
     const auto scanEnd = std::chrono::steady_clock::now ();
     const auto scanMs =
         std::chrono::duration_cast<std::chrono::milliseconds> (scanEnd - scanStart).count ();
 
-    size_t validCount = 0;
-    size_t licenseSkipCount = 0;
-    size_t failedCount = 0;
-    for (const auto& p : finalPlugins)
+    if (!scanOptions.quiet)
     {
-        if (p.isValid)
-            ++validCount;
-        if (p.missingLicense)
-            ++licenseSkipCount;
-        if (p.loadFailed)
-            ++failedCount;
+        status << "Scan complete in " << scanMs << " ms (valid: " << totals.valid
+               << ", missingLicense: " << totals.missingLicense << ", failed: " << totals.failed
+               << ")" << std::endl;
+        if (profile)
+            profile->writeSummary (status);
+        if (scannedCount < vstFiles.size ())
+            status << "Partial catalog: " << scannedCount << " of " << vstFiles.size ()
+                   << " plugins scanned; run again"
+                   << (scanOptions.budgetSec > 0 ? "" : " with --resume") << " to finish"
+                   << std::endl;
     }
 
-    if (!scanOptions.quiet)
+    const auto abandoned = VSTScanner::abandonedLoads ();
+    if (!abandoned.empty () && !scanOptions.quiet)
     {
-        std::cout << "Scan complete in " << scanMs << " ms (valid: " << validCount
-                  << ", missingLicense: " << licenseSkipCount << ", failed: " << failedCount
-                  << ")" << std::endl;
+        status << "Abandoned " << abandoned.size () << " hung plugin loads ("
+               << VSTScanner::abandonedLoadsStillRunning () << " still running):" << std::endl;
+        for (const auto& load : abandoned)
+        {
+            status << "  " << load.path << " (timeout " << load.timeoutSec << "s, ";
+            if (load.finished)
+                status << "returned " << load.finishedLateMs << " ms later)" << std::endl;
+            else
+                status << "still running)" << std::endl;
+        }
     }
 
-    if (outputFile.empty () && cumulativeFile.empty ())
+    if (streamNDJSON)
+    {
+        if (!outputFileName.empty () && !scanOptions.quiet)
+            status << "Results written to: " << outputFileName << std::endl;
+    }
+    else if (outputFileName.empty ())
     {
-        VSTScanner::outputJSON (finalPlugins, std::cout);
+        const auto writeStart = std::chrono::steady_clock::now ();
+        if (serveSocket.empty ())
+            VSTScanner::outputJSON (finalPlugins, std::cout, profile);
+        traceMain ("write catalog", writeStart);
     }
     else
     {
-        const std::string outputFileName = useCumulative ? cumulativeFile : outputFile;
-        std::ofstream outFile (outputFileName);
+        const auto writeStart = std::chrono::steady_clock::now ();
+        outFile.open (outputFileName, catalogOpenMode (outputFormat));
         if (outFile.is_open ())
         {
-            VSTScanner::outputJSON (finalPlugins, outFile);
+            writeCatalog (finalPlugins, outputFormat, outFile, profile);
+            outFile.flush ();
+            traceMain ("write catalog", writeStart);
             if (!scanOptions.quiet)
-                std::cout << "Results written to: " << outputFileName << std::endl;
+                status << "Results written to: " << outputFileName << std::endl;
         }
         else
         {
@@ -1229,6 +746,94 @@ int main (int argc, char* argv[])
             return 1;
         }
     }
+    outFile.close ();
+
+    // The catalog now holds everything the journal did.
+    if (!scanOptions.journalFile.empty () && scannedCount == vstFiles.size ())
+    {
+        std::error_code ec;
+        std::filesystem::remove (scanOptions.journalFile, ec);
+    }
+
+    // Watch rescans are not traced; the file covers the initial scan.
+    if (trace)
+    {
+        scanOptions.trace = nullptr;
+        std::ofstream traceOut (traceFile, std::ios::trunc);
+        trace->writeJSON (traceOut);
+        if (!traceOut)
+        {
+            std::cerr << "Error: Could not write trace file: " << traceFile << std::endl;
+            return 1;
+        }
+        if (!scanOptions.quiet)
+            status << "Trace written to: " << traceFile << std::endl;
+    }
+
+#if SMTG_OS_LINUX || SMTG_OS_MACOS
+    if (watch || !serveSocket.empty ())
+    {
+        // Rescans run unbudgeted and unjournaled.
+        scanOptions.budgetSec = 0;
+        scanOptions.journalFile.clear ();
+        scanOptions.resumeJournal = false;
+
+        ::signal (SIGINT, requestStop);
+        ::signal (SIGTERM, requestStop);
+
+        std::unique_ptr<VSTScanner::CatalogServer> server;
+        if (!serveSocket.empty ())
+        {
+            server = std::make_unique<VSTScanner::CatalogServer> (serveSocket);
+            if (!server->start (finalPlugins))
+                return 1;
+        }
+
+#if SMTG_OS_LINUX
+        if (watch)
+        {
+            // Readers of the output file never see a half-written catalog.
+            const auto publish = [&] (const std::vector<VSTScanner::PluginInfo>& catalog) {
+                if (server)
+                    server->update (catalog);
+                if (outputFileName.empty ())
+                    return;
+
+                const auto tmp = outputFileName + ".tmp";
+                {
+                    std::ofstream out (tmp, catalogOpenMode (outputFormat));
+                    writeCatalog (catalog, outputFormat, out);
+                    if (!out)
+                    {
+                        std::cerr << "Error: Could not write output file: " << tmp << std::endl;
+                        return;
+                    }
+                }
+                std::error_code ec;
+                std::filesystem::rename (tmp, outputFileName, ec);
+                if (ec)
+                    std::cerr << "Error: Could not replace " << outputFileName << ": "
+                              << ec.message () << std::endl;
+            };
+            if (!VSTScanner::watchPlugins (directory, finalPlugins, scanOptions, watchOptions,
+                                           publish))
+                return 1;
+        }
+#endif
+        while (!stopRequested)
+            std::this_thread::sleep_for (std::chrono::milliseconds (250));
+        if (server)
+            server->stop ();
+    }
+#endif
+
+    // Abandoned loader threads may still be inside plugin code; exiting normally would run
+    // static destructors and unload modules underneath them.
+    if (VSTScanner::abandonedLoadsStillRunning () > 0)
+    {
+        std::cout.flush ();
+        std::_Exit (0);
+    }
 
     return 0;
 }
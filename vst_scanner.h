@@ -0,0 +1,458 @@
+//-----------------------------------------------------------------------------
+// VST Scanner
+// Description: Scanning library API: discovery, factory loads, catalogs and merging
+//-----------------------------------------------------------------------------
+//
+// Link vst_scanner_core to scan from inside a host process. Results arrive as PluginInfo
+// through callbacks; nothing goes through JSON unless a catalog is written. With
+// ScanOptions::isolateFactoryLoad, plugins are loaded in pre-forked worker processes (Linux)
+// or in vst_scanner.exe workers (Windows), so a crashing plugin cannot take the host down.
+// On Linux the first isolated scanPlugins call forks a single-threaded fork server that forks
+// every worker; make that call before the host has threads that hold locks a child could need.
+
+#pragma once
+
+#include "vst3sdk/pluginterfaces/base/fplatform.h"
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+//------------------------------------------------------------------------
+namespace VSTScanner {
+
+//------------------------------------------------------------------------
+// What the pre-load heuristics saw in a module. Computed once per module and shared by every
+// skip and timeout decision; also written to the JSON so skips can be explained.
+struct ModuleAnalysis {
+    bool analyzed {false};
+    uint64_t moduleSize {0};                  // file, or sum of bundle binaries
+    std::vector<std::string> licenseWrappers; // PACE/iLok DLLs found inside the bundle
+    bool licenseMarkers {false};              // PACE/iLok strings in a monolithic binary
+    bool headlessUnsafeVendor {false};        // path matches a vendor that blocks headless loads
+    std::string binaryProblem;                // Linux: why dlopen would fail (ELF machine,
+                                              // missing DT_NEEDED libraries); empty = none seen
+
+    bool needsLicense () const { return !licenseWrappers.empty () || licenseMarkers; }
+    bool unsafeFactoryLoad () const { return !needsLicense () && headlessUnsafeVendor; }
+};
+
+//------------------------------------------------------------------------
+// Where one plugin's scan time went, in steady_clock microseconds. Always recorded (a handful
+// of clock reads per plugin); written to the output only under --profile.
+struct ScanTimings {
+    uint32_t cacheUs {0};      // scan-cache lookup (stat, plus fingerprint when the stamp moved)
+    uint32_t analyzeUs {0};    // moduleinfo.json and pre-load heuristics (license markers too)
+    uint32_t moduleLoadUs {0}; // Module::create: dlopen/LoadLibrary and module entry
+    uint32_t classInfoUs {0};  // getFactory ().classInfos ()
+    uint32_t workerUs {0};     // isolated worker spawn and IPC, beyond the load itself
+    uint32_t totalUs {0};      // the whole per-plugin scan
+};
+
+//------------------------------------------------------------------------
+// One class exported by a module's factory. Shell modules (many effects in one binary) have
+// one entry per effect; processor and controller classes are listed alike.
+struct PluginClassInfo {
+    std::string name;
+    std::string category; // "Audio Module Class", "Component Controller Class", ...
+    std::vector<std::string> subCategories;
+    std::string cid;
+    std::string vendor;
+    std::string version;
+    std::string sdkVersion;
+    int32_t cardinality {0};
+    uint32_t flags {0};
+};
+
+//------------------------------------------------------------------------
+// The name/vendor/.../flags fields describe the module's primary class: its first audio
+// effect, else its first class. classes lists every class the factory exported.
+struct PluginInfo {
+    std::string path;
+    std::string name;
+    std::string vendor;
+    std::string version;
+    std::vector<std::string> categories;
+    std::string cid;
+    std::string sdkVersion;
+    int32_t cardinality {0};
+    uint32_t flags {0};
+    bool isValid {false};
+    bool missingLicense {false};
+    bool loadFailed {false};
+    bool loadTimedOut {false};
+    std::string errorMessage;
+    std::string scanSource; // "factory", "moduleinfo" or "skipped"
+    std::vector<std::string> aliases; // other paths discovery found to the same module
+    ModuleAnalysis analysis;
+    std::vector<PluginClassInfo> classes;
+    ScanTimings timings;
+};
+
+//------------------------------------------------------------------------
+// Scan timeline for --trace, written as a Chrome Trace Event file (chrome://tracing, Perfetto).
+// Every recording thread owns a Track and appends to it without locking; only addTrack takes
+// the mutex, once per thread. Tracks are read by writeJSON after their threads are joined.
+class ScanTrace
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    class Track
+    {
+    public:
+        // outcome is a string literal; path is set on the per-plugin "scan" span only.
+        void span (const char* name, Clock::time_point start, Clock::time_point end,
+                   const std::string& path = {}, const char* outcome = nullptr)
+        {
+            Event event;
+            event.name = name;
+            event.startUs = sinceEpoch (start);
+            event.durationUs = end > start ? sinceEpoch (end) - event.startUs : 0;
+            event.path = path;
+            event.outcome = outcome;
+            events.push_back (std::move (event));
+        }
+
+    private:
+        friend class ScanTrace;
+
+        struct Event
+        {
+            const char* name {nullptr};
+            uint64_t startUs {0};
+            uint64_t durationUs {0};
+            std::string path;
+            const char* outcome {nullptr};
+        };
+
+        Track (Clock::time_point epoch, std::string name) : epoch (epoch), name (std::move (name))
+        {
+            events.reserve (1024);
+        }
+
+        uint64_t sinceEpoch (Clock::time_point t) const
+        {
+            return t > epoch ? static_cast<uint64_t> (
+                                   std::chrono::duration_cast<std::chrono::microseconds> (t - epoch)
+                                       .count ())
+                             : 0;
+        }
+
+        Clock::time_point epoch;
+        std::string name;
+        std::vector<Event> events;
+    };
+
+    // The returned track stays valid for the trace's lifetime.
+    Track& addTrack (std::string name);
+    void writeJSON (std::ostream& out) const;
+
+private:
+    Clock::time_point epoch {Clock::now ()};
+    mutable std::mutex mutex;
+    std::vector<std::unique_ptr<Track>> tracks;
+};
+
+//------------------------------------------------------------------------
+// Progress of one plugin: its index into the scanned paths, the path count, and the phase
+// ("scanning" when a worker picks it up, "done" when it is classified). Called from scan
+// worker threads, but never from two at once: parallel scans hold the log lock around it.
+using ScanProgressCallback =
+    std::function<void (size_t index, size_t total, const std::string& path, const char* phase)>;
+
+//------------------------------------------------------------------------
+struct ScanOptions {
+    bool quiet {false};
+    unsigned factoryLoadTimeoutSec {5};
+    unsigned protectedPluginTimeoutSec {2};
+    bool skipFactoryLoad {false};
+    bool fastLicenseSkip {true};
+    bool checkModuleBinary {true};          // fail on ModuleAnalysis::binaryProblem, no load
+    bool isolateFactoryLoad {false};
+    bool useModuleInfo {true};              // describe bundles from moduleinfo.json, no load
+    bool verifyModuleInfo {false};          // load them anyway and check the file against it
+    unsigned jobs {1};                      // parallel factory-load workers (0 = one per core)
+    unsigned maxInFlightLoadsPerWorker {4}; // loads (incl. timed-out ones) a worker may hold
+    unsigned maxAbandonedLoads {8};         // hung loader threads tolerated before refusing loads
+    std::string cacheFile;                  // persistent scan cache; empty = disabled
+    int cacheRetryFailedHours {24};         // reload cached failures after this (0 = always, -1 = never)
+    bool prioritizeFromHistory {true};      // with a cache: fast modules first, hung ones last
+    unsigned slowLaneJobs {1};              // workers that may load previously hung modules at once
+    unsigned budgetSec {0};                 // start no plugin after this long (0 = no limit)
+    std::string journalFile;                // append each finished plugin here (NDJSON)
+    bool resumeJournal {false};             // take journaled results instead of rescanning
+    ScanTrace* trace {nullptr};             // --trace: record each worker's timeline
+    ScanProgressCallback onProgress;        // optional, in addition to the log lines
+    std::string workerExecutable;           // Windows --isolate: vst_scanner.exe to run as the
+                                            // worker (empty = this executable)
+};
+
+//------------------------------------------------------------------------
+// An in-process load that outlived its timeout; its thread was detached, not joined.
+struct AbandonedLoad {
+    std::string path;
+    unsigned timeoutSec {0};
+    bool finished {false};        // Module::create eventually returned
+    long long finishedLateMs {0}; // how long after the timeout it returned
+};
+
+//------------------------------------------------------------------------
+// Receives each plugin as soon as it is classified: index into the scanned paths, and the
+// result. Called from scan worker threads, in completion order.
+using PluginResultCallback = std::function<void (size_t index, PluginInfo&& info)>;
+
+//------------------------------------------------------------------------
+struct ScanTotals {
+    size_t total {0};
+    size_t valid {0};
+    size_t missingLicense {0};
+    size_t failed {0};
+
+    void add (const PluginInfo& plugin)
+    {
+        ++total;
+        valid += plugin.isValid ? 1 : 0;
+        missingLicense += plugin.missingLicense ? 1 : 0;
+        failed += plugin.loadFailed ? 1 : 0;
+    }
+};
+
+//------------------------------------------------------------------------
+// Aggregates ScanTimings over a run (--profile). Every phase keeps a log-linear histogram
+// (exact below 8 µs, then 8 buckets per power of two, so percentiles are within 12.5%):
+// add () is O(1) and memory stays constant however many plugins stream through. Phases that
+// did not run for a plugin (0 µs, e.g. the load of a cached or skipped plugin) are not counted.
+class ScanProfile
+{
+public:
+    void add (const ScanTimings& timings);
+    void setDiscoveryMs (double ms) { discoveryMs = ms; }
+    void setScanMs (double ms) { scanMs = ms; }
+
+    void writeJSON (std::ostream& out) const;
+    void writeSummary (std::ostream& out) const;
+
+private:
+    static constexpr size_t kPhaseCount = 6;
+    static constexpr size_t kBucketCount = 240;
+
+    struct Phase
+    {
+        std::array<uint32_t, kBucketCount> buckets {};
+        uint64_t count {0};
+        uint64_t totalUs {0};
+        uint32_t maxUs {0};
+
+        void add (uint32_t us);
+        uint32_t percentile (double q) const;
+    };
+
+    static const char* phaseName (size_t phase);
+
+    mutable std::mutex mutex;
+    std::array<Phase, kPhaseCount> phases;
+    double discoveryMs {0};
+    double scanMs {0};
+};
+
+//------------------------------------------------------------------------
+class NDJSONWriter
+{
+public:
+    // With a profile, every record carries its timings, each one is added to the profile,
+    // and the summary line carries the aggregate.
+    explicit NDJSONWriter (std::ostream& out, ScanProfile* profile = nullptr);
+
+    void write (const PluginInfo& plugin);
+    void writeSummary ();
+    ScanTotals totals ();
+
+private:
+    std::ostream& out;
+    ScanProfile* profile;
+    std::mutex mutex;
+    ScanTotals counts;
+    std::string lineBuffer; // reused for every record; guarded by mutex
+};
+
+//------------------------------------------------------------------------
+// What mergePlugins does when an incoming record matches one it already holds.
+enum class MergePolicy {
+    keepOld,            // first record wins (cumulative files never lose entries)
+    replaceWithNewer,   // later record wins
+    keepValidOverFailed // later record wins unless it failed and the held one is valid
+};
+
+struct MergeOptions {
+    MergePolicy policy {MergePolicy::keepOld};
+    bool matchCid {false}; // records with equal non-empty CIDs match even at different paths
+};
+
+//------------------------------------------------------------------------
+struct WatchOptions {
+    unsigned debounceMs {2000}; // quiet time after the last change before rescanning
+};
+
+using CatalogChangedCallback = std::function<void (const std::vector<PluginInfo>& catalog)>;
+
+//------------------------------------------------------------------------
+// Discovery and scanning
+
+// Sends the scanner's progress and summary lines to out (default: std::cout).
+void setLogStream (std::ostream& out);
+
+// One module found by discovery. Hard links, symlinked bundles and modules inside a symlinked
+// folder are the same module: path is the shallowest of its paths, aliases the others.
+struct DiscoveredModule {
+    std::string path;
+    std::vector<std::string> aliases;
+};
+
+// Every .vst3 bundle or module (and .so on Linux) below directory, once per (device, inode),
+// sorted by path; threads = 0 walks with one thread per core. A directory already walked
+// through another path is not walked again, so symlink loops end.
+std::vector<DiscoveredModule> discoverModules (const std::string& directory,
+                                               unsigned threads = 0);
+
+// The primary paths of discoverModules.
+std::vector<std::string> findVSTFiles (const std::string& directory, unsigned threads = 0);
+
+// The pre-load heuristics for one module: license wrappers and markers, size, vendor rules,
+// and on Linux a static check of the ELF binary and its DT_NEEDED libraries.
+ModuleAnalysis analyzeModule (const std::filesystem::path& modulePath);
+
+// Fills info (classes, primary class, scanSource "moduleinfo") from the bundle's
+// Contents/Resources/moduleinfo.json without loading the module. False if it has none or the
+// file lists no classes.
+bool readModuleInfo (const std::filesystem::path& modulePath, PluginInfo& info);
+
+// True if data contains a PACE/iLok marker string (what analyzeModule looks for in
+// monolithic modules).
+bool bufferHasLicenseMarkers (const char* data, size_t size);
+
+// Loads one module in this process and thread, with no timeout or isolation.
+PluginInfo scanPluginFromFactory (const std::string& pluginPath);
+
+// Sets missingLicense / loadFailed / loadTimedOut from a failed result's error message.
+void classifyPluginFailure (PluginInfo& info);
+
+// Scans paths as options say, delivering each result as soon as it is classified. Results
+// resumed from the journal are delivered first. Once budgetSec has passed no further plugin
+// is started; those paths get no result.
+void scanPlugins (const std::vector<std::string>& paths, const ScanOptions& options,
+                  const PluginResultCallback& onResult);
+
+// Same, collected in input order. Plugins a budget cut off are left out.
+std::vector<PluginInfo> scanPlugins (const std::vector<std::string>& paths,
+                                     const ScanOptions& options);
+
+// In-process loads that outlived their timeout, this process's lifetime.
+std::vector<AbandonedLoad> abandonedLoads ();
+size_t abandonedLoadsStillRunning ();
+
+//------------------------------------------------------------------------
+// Catalogs
+
+std::string escapeJSONString (const std::string& input);
+
+void outputJSON (const std::vector<PluginInfo>& plugins, std::ostream& out,
+                 const ScanProfile* profile = nullptr);
+
+void outputBinaryCatalog (const std::vector<PluginInfo>& plugins, std::ostream& out);
+
+// Read-only view of a binary catalog (--format bin), memory-mapped rather than parsed. Opening
+// checks the header and that every section lies inside the file; lookups go through the
+// file's path and CID hash indexes. The string accessors point into the mapping and stay
+// valid as long as the view; plugin () copies out one record. Indexes must be < size ().
+class BinaryCatalogView
+{
+public:
+    static constexpr size_t npos = static_cast<size_t> (-1);
+
+    explicit BinaryCatalogView (const std::string& filename);
+    ~BinaryCatalogView ();
+
+    BinaryCatalogView (const BinaryCatalogView&) = delete;
+    BinaryCatalogView& operator= (const BinaryCatalogView&) = delete;
+
+    bool valid () const;
+    size_t size () const;
+
+    // Index of the plugin at path / with this CID (primary or any class), or npos.
+    size_t findPath (std::string_view path) const;
+    size_t findCid (std::string_view cid) const;
+
+    std::string_view path (size_t index) const;
+    std::string_view name (size_t index) const;
+    std::string_view vendor (size_t index) const;
+    std::string_view cid (size_t index) const;
+    bool isValid (size_t index) const;
+
+    PluginInfo plugin (size_t index) const;
+    std::vector<PluginInfo> plugins () const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+std::vector<PluginInfo> parseJSONCatalog (const char* data, size_t size);
+std::vector<PluginInfo> parseExistingJSON (const std::string& filename);
+
+// Reads a catalog in any format this scanner writes: JSON, NDJSON or binary.
+std::vector<PluginInfo> loadCatalogFile (const std::string& filename);
+
+std::vector<PluginInfo> mergePlugins (std::vector<PluginInfo> existing,
+                                      std::vector<PluginInfo> newPlugins,
+                                      const MergeOptions& options = {});
+
+#if SMTG_OS_LINUX
+//------------------------------------------------------------------------
+// Keeps catalog in sync with the modules below root until stopWatching () is called;
+// onChanged receives the catalog after every rescan that altered it. Returns false if
+// inotify is unavailable.
+bool watchPlugins (const std::string& root, std::vector<PluginInfo>& catalog,
+                   const ScanOptions& options, const WatchOptions& watchOptions,
+                   const CatalogChangedCallback& onChanged);
+
+// Async-signal-safe.
+void stopWatching ();
+#endif
+
+#if SMTG_OS_LINUX || SMTG_OS_MACOS
+//------------------------------------------------------------------------
+// Serves a resident catalog on a Unix domain socket; see the query protocol in
+// vst_scanner_core.cpp and the README.
+class CatalogServer
+{
+public:
+    explicit CatalogServer (std::string socketPath);
+    ~CatalogServer ();
+
+    CatalogServer (const CatalogServer&) = delete;
+    CatalogServer& operator= (const CatalogServer&) = delete;
+
+    bool start (const std::vector<PluginInfo>& catalog);
+    void update (const std::vector<PluginInfo>& catalog);
+    void stop ();
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+bool queryCatalogServer (const std::string& socketPath, const std::string& request,
+                         std::ostream& out);
+#endif
+
+//------------------------------------------------------------------------
+} // namespace VSTScanner
@@ -0,0 +1,6144 @@
+//-----------------------------------------------------------------------------
+// VST Scanner
+// Description: Scanning library (vst_scanner_core): discovery, factory loads, catalogs
+//-----------------------------------------------------------------------------
+
+#include "vst_scanner.h"
+#include "vst3sdk/public.sdk/source/vst/hosting/module.h"
+#include "vst3sdk/pluginterfaces/base/fplatform.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <shared_mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#if SMTG_OS_WINDOWS
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#elif SMTG_OS_LINUX
+#include <dirent.h>
+#include <elf.h>
+#include <link.h>
+#include <sys/inotify.h>
+#include <sys/utsname.h>
+#include <sys/wait.h>
+#endif
+
+#if SMTG_OS_LINUX || SMTG_OS_MACOS
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+//------------------------------------------------------------------------
+namespace VSTScanner {
+
+//------------------------------------------------------------------------
+namespace {
+
+std::string toLowerAscii (std::string value)
+{
+    for (char& c : value)
+    {
+        if (c >= 'A' && c <= 'Z')
+            c = static_cast<char> (c - 'A' + 'a');
+    }
+    return value;
+}
+
+bool stringContainsInsensitive (const std::string& haystack, const std::string& needle)
+{
+    const auto h = toLowerAscii (haystack);
+    const auto n = toLowerAscii (needle);
+    return h.find (n) != std::string::npos;
+}
+
+bool isLikelyLicenseError (const std::string& errorMessage)
+{
+    static const char* keywords[] = {
+        "ilok",
+        "pace",
+        "license",
+        "licence",
+        "activation",
+        "not authorized",
+        "unauthorized",
+        "0x715",
+        "cannot be found",
+        "reinstall",
+        "noauthorizedlicenses",
+        "authorization required",
+        "licensedaemon",
+        nullptr,
+    };
+
+    for (const char** kw = keywords; *kw != nullptr; ++kw)
+    {
+        if (stringContainsInsensitive (errorMessage, *kw))
+            return true;
+    }
+    return false;
+}
+
+} // anonymous
+
+void classifyPluginFailure (PluginInfo& info)
+{
+    if (info.isValid)
+        return;
+
+    if (stringContainsInsensitive (info.errorMessage, "timed out"))
+    {
+        info.loadTimedOut = true;
+        info.loadFailed = true;
+        return;
+    }
+
+    if (isLikelyLicenseError (info.errorMessage))
+    {
+        info.missingLicense = true;
+        if (info.errorMessage.empty ())
+            info.errorMessage = "Missing or invalid license (iLok/PACE)";
+        return;
+    }
+
+    info.loadFailed = true;
+}
+
+//------------------------------------------------------------------------
+namespace {
+
+std::ostream* logOut = &std::cout;
+std::recursive_mutex logMutex;
+
+void logLine (const std::string& msg)
+{
+    std::lock_guard<std::recursive_mutex> lock (logMutex);
+    *logOut << msg << std::endl;
+    logOut->flush ();
+}
+
+// Hold while emitting several related log lines so parallel workers do not interleave them.
+std::unique_lock<std::recursive_mutex> lockLog ()
+{
+    return std::unique_lock<std::recursive_mutex> (logMutex);
+}
+
+bool dllNameSuggestsLicenseWrapper (const std::string& fileName)
+{
+    const auto lower = toLowerAscii (fileName);
+    return lower.find ("pace") != std::string::npos || lower.find ("ilok") != std::string::npos ||
+           lower.find ("wraptool") != std::string::npos ||
+           lower.find ("pacefusion") != std::string::npos ||
+           lower.find ("paceeden") != std::string::npos;
+}
+
+// One pass over the bundle's Contents/<arch>/ binaries: license wrapper DLLs and total size.
+void inspectBundle (const std::filesystem::path& modulePath, ModuleAnalysis& analysis)
+{
+    std::error_code ec;
+    const auto contents = modulePath / "Contents";
+    if (!std::filesystem::exists (contents, ec))
+        return;
+
+    for (const auto& archEntry : std::filesystem::directory_iterator (contents, ec))
+    {
+        if (ec || !archEntry.is_directory (ec))
+            continue;
+
+        for (const auto& fileEntry :
+             std::filesystem::directory_iterator (archEntry.path (), ec))
+        {
+            if (ec || !fileEntry.is_regular_file (ec))
+                continue;
+
+            const auto size = fileEntry.file_size (ec);
+            if (!ec)
+                analysis.moduleSize += size;
+
+            const auto fileName = fileEntry.path ().filename ().string ();
+            if (fileEntry.path ().extension () == ".dll" && dllNameSuggestsLicenseWrapper (fileName))
+                analysis.licenseWrappers.push_back (fileName);
+        }
+    }
+
+    std::sort (analysis.licenseWrappers.begin (), analysis.licenseWrappers.end ());
+}
+
+//------------------------------------------------------------------------
+// ASCII case-insensitive multi-needle matcher: an Aho-Corasick automaton flattened into a
+// 256-wide DFA, so a buffer is checked for every needle in one pass at one table lookup per
+// byte, with no backtracking and no per-needle rescans.
+class MultiNeedleMatcher
+{
+public:
+    explicit MultiNeedleMatcher (std::initializer_list<const char*> needles)
+    {
+        // Trie over lowercased needles; -1 marks a missing edge until the DFA fill below.
+        std::vector<std::array<int, 256>> trie (1);
+        trie[0].fill (-1);
+        std::vector<uint8_t> accepting (1, 0);
+
+        for (const char* needle : needles)
+        {
+            int state = 0;
+            for (const char* p = needle; *p != '\0'; ++p)
+            {
+                const auto c = foldAscii (static_cast<unsigned char> (*p));
+                if (trie[state][c] < 0)
+                {
+                    trie[state][c] = static_cast<int> (trie.size ());
+                    trie.emplace_back ().fill (-1);
+                    accepting.push_back (0);
+                }
+                state = trie[state][c];
+            }
+            accepting[state] = 1;
+        }
+
+        // Breadth-first: every state's failure target is finalized before its children need it.
+        const size_t stateCount = trie.size ();
+        next.assign (stateCount * 256, 0);
+        std::vector<int> fail (stateCount, 0);
+        std::vector<int> queue;
+        queue.reserve (stateCount);
+
+        for (int c = 0; c < 256; ++c)
+        {
+            const int child = trie[0][c];
+            next[c] = static_cast<uint16_t> (child < 0 ? 0 : child);
+            if (child > 0)
+                queue.push_back (child);
+        }
+
+        for (size_t head = 0; head < queue.size (); ++head)
+        {
+            const int state = queue[head];
+            accepting[state] |= accepting[fail[state]];
+            for (int c = 0; c < 256; ++c)
+            {
+                const int child = trie[state][c];
+                const uint16_t viaFail = next[fail[state] * 256 + c];
+                if (child < 0)
+                {
+                    next[state * 256 + c] = viaFail;
+                    continue;
+                }
+                fail[child] = viaFail;
+                next[state * 256 + c] = static_cast<uint16_t> (child);
+                queue.push_back (child);
+            }
+        }
+
+        // Fold case into the table itself, and send every edge into an accepting state to one
+        // shared hit state, so the scan loop is a table load plus a compare per byte.
+        hitState = static_cast<uint16_t> (stateCount);
+        for (auto& target : next)
+        {
+            if (accepting[target])
+                target = hitState;
+        }
+        for (size_t state = 0; state < stateCount; ++state)
+        {
+            for (int c = 'A'; c <= 'Z'; ++c)
+                next[state * 256 + c] = next[state * 256 + (c - 'A' + 'a')];
+        }
+        for (int c = 0; c < 256; ++c)
+            leavesRoot[c] = next[c] != 0;
+    }
+
+    bool matches (const char* data, size_t size) const
+    {
+        const auto* bytes = reinterpret_cast<const unsigned char*> (data);
+        const uint16_t* table = next.data ();
+        uint16_t state = 0;
+        for (size_t i = 0; i < size; ++i)
+        {
+            // Most bytes cannot start a needle; skip them without the state dependency chain.
+            if (state == 0)
+            {
+                while (i < size && !leavesRoot[bytes[i]])
+                    ++i;
+                if (i == size)
+                    break;
+            }
+            state = table[state * 256u + bytes[i]];
+            if (state == hitState)
+                return true;
+        }
+        return false;
+    }
+
+private:
+    static unsigned char foldAscii (unsigned char c)
+    {
+        return (c >= 'A' && c <= 'Z') ? static_cast<unsigned char> (c - 'A' + 'a') : c;
+    }
+
+    std::vector<uint16_t> next; // state * 256 + byte -> state
+    std::array<bool, 256> leavesRoot {};
+    uint16_t hitState {0};
+};
+
+bool binaryChunkHasLicenseMarker (const char* data, size_t size)
+{
+    static const MultiNeedleMatcher markers {
+        "pacefusion",
+        "paceeden",
+        "wraptool",
+        "ilok",
+        "noauthorizedlicensesfound",
+        "authorization required",
+        "licensedaemon",
+    };
+
+    return markers.matches (data, size);
+}
+
+using BinaryMarkerCheck = bool (*) (const char* data, size_t size);
+
+//------------------------------------------------------------------------
+// Read-only mapping of a whole file. Marker windows are checked straight in the mapped pages,
+// so only the pages a window touches are ever read and nothing is copied. valid () is false
+// when the OS refuses the mapping (some network and FUSE filesystems); callers fall back to
+// stream reads then.
+class MappedFile
+{
+public:
+    explicit MappedFile (const std::filesystem::path& path)
+    {
+#if SMTG_OS_WINDOWS
+        file = CreateFileW (path.wstring ().c_str (), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                            OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE)
+            return;
+        LARGE_INTEGER fileSize {};
+        if (!GetFileSizeEx (file, &fileSize) || fileSize.QuadPart == 0)
+            return;
+        mapping = CreateFileMappingW (file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping == nullptr)
+            return;
+        const void* view = MapViewOfFile (mapping, FILE_MAP_READ, 0, 0, 0);
+        if (view == nullptr)
+            return;
+        bytes = static_cast<const char*> (view);
+        length = static_cast<size_t> (fileSize.QuadPart);
+#elif SMTG_OS_LINUX || SMTG_OS_MACOS
+        const int fd = ::open (path.c_str (), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return;
+        struct stat st {};
+        if (::fstat (fd, &st) == 0 && st.st_size > 0)
+        {
+            void* view = ::mmap (nullptr, static_cast<size_t> (st.st_size), PROT_READ, MAP_PRIVATE,
+                                 fd, 0);
+            if (view != MAP_FAILED)
+            {
+                bytes = static_cast<const char*> (view);
+                length = static_cast<size_t> (st.st_size);
+                // Only a few windows of the file are read; don't let readahead pull in the rest.
+                ::madvise (view, length, MADV_RANDOM);
+            }
+        }
+        ::close (fd); // the mapping keeps its own reference
+#endif
+    }
+
+    ~MappedFile ()
+    {
+#if SMTG_OS_WINDOWS
+        if (bytes != nullptr)
+            UnmapViewOfFile (bytes);
+        if (mapping != nullptr)
+            CloseHandle (mapping);
+        if (file != INVALID_HANDLE_VALUE)
+            CloseHandle (file);
+#elif SMTG_OS_LINUX || SMTG_OS_MACOS
+        if (bytes != nullptr)
+            ::munmap (const_cast<char*> (bytes), length);
+#endif
+    }
+
+    MappedFile (const MappedFile&) = delete;
+    MappedFile& operator= (const MappedFile&) = delete;
+
+    bool valid () const { return bytes != nullptr; }
+    const char* data () const { return bytes; }
+    size_t size () const { return length; }
+
+    // Tells the kernel a window is about to be read front to back.
+    void adviseSequential (size_t offset, size_t count) const
+    {
+#if SMTG_OS_LINUX || SMTG_OS_MACOS
+        const auto page = static_cast<size_t> (::sysconf (_SC_PAGESIZE));
+        const size_t start = offset - offset % page;
+        ::madvise (const_cast<char*> (bytes) + start, offset + count - start, MADV_SEQUENTIAL);
+        ::madvise (const_cast<char*> (bytes) + start, offset + count - start, MADV_WILLNEED);
+#else
+        (void)offset;
+        (void)count;
+#endif
+    }
+
+private:
+    const char* bytes {nullptr};
+    size_t length {0};
+#if SMTG_OS_WINDOWS
+    HANDLE file {INVALID_HANDLE_VALUE};
+    HANDLE mapping {nullptr};
+#endif
+};
+
+// Stream fallback for files that cannot be mapped. One buffer holds the carried-over tail of
+// the previous chunk followed by the new read, so markers spanning a chunk boundary are still
+// seen without allocating or copying a chunk per iteration.
+bool scanFileRangeForMarkers (std::ifstream& file, size_t offset, size_t length,
+                              BinaryMarkerCheck check)
+{
+    file.clear ();
+    file.seekg (static_cast<std::streamoff> (offset), std::ios::beg);
+    if (!file)
+        return false;
+
+    constexpr size_t kChunkSize = 256 * 1024;
+    constexpr size_t kOverlap = 64;
+    std::vector<char> buffer (kOverlap + kChunkSize);
+    size_t carried = 0;
+    size_t remaining = length;
+
+    while (remaining > 0 && file)
+    {
+        const auto toRead = (std::min) (kChunkSize, remaining);
+        file.read (buffer.data () + carried, static_cast<std::streamsize> (toRead));
+        const auto bytesRead = static_cast<size_t> (file.gcount ());
+        if (bytesRead == 0)
+            break;
+
+        remaining -= bytesRead;
+
+        const size_t filled = carried + bytesRead;
+        if (check (buffer.data (), filled))
+            return true;
+
+        carried = (std::min) (filled, kOverlap);
+        std::memmove (buffer.data (), buffer.data () + filled - carried, carried);
+    }
+
+    return false;
+}
+
+bool binaryFileHasMarkers (const std::filesystem::path& filePath, BinaryMarkerCheck check)
+{
+    std::error_code ec;
+    const auto fileSize = std::filesystem::file_size (filePath, ec);
+    if (ec || fileSize == 0)
+        return false;
+
+    constexpr size_t kHeadScan = 4 * 1024 * 1024;
+    constexpr size_t kMidOffset = 20 * 1024 * 1024;
+    constexpr size_t kMidScan = 8 * 1024 * 1024;
+    constexpr size_t kTailScan = 2 * 1024 * 1024;
+
+    struct Window
+    {
+        size_t offset;
+        size_t length;
+    };
+    Window windows[3];
+    size_t windowCount = 0;
+    windows[windowCount++] = {0, (std::min) (static_cast<size_t> (fileSize), kHeadScan)};
+    if (fileSize > kMidOffset)
+        windows[windowCount++] = {kMidOffset, (std::min) (kMidScan, fileSize - kMidOffset)};
+    if (fileSize > kTailScan)
+        windows[windowCount++] = {fileSize - kTailScan, kTailScan};
+
+    const MappedFile mapped (filePath);
+    if (mapped.valid () && mapped.size () == fileSize)
+    {
+        for (size_t w = 0; w < windowCount; ++w)
+        {
+            mapped.adviseSequential (windows[w].offset, windows[w].length);
+            if (check (mapped.data () + windows[w].offset, windows[w].length))
+                return true;
+        }
+        return false;
+    }
+
+    std::ifstream file (filePath, std::ios::binary);
+    if (!file)
+        return false;
+
+    for (size_t w = 0; w < windowCount; ++w)
+    {
+        if (scanFileRangeForMarkers (file, windows[w].offset, windows[w].length, check))
+            return true;
+    }
+
+    return false;
+}
+
+bool monolithicModuleHasLicenseMarkers (const std::filesystem::path& modulePath)
+{
+    return binaryFileHasMarkers (modulePath, binaryChunkHasLicenseMarker);
+}
+
+bool pathSuggestsHeadlessUnsafeVendor (const std::filesystem::path& modulePath)
+{
+    // Win32 APIs like MessageBeep/PlaySound appear in most plugin DLLs — do not scan for those.
+    // Known vendors that beep/hang on headless factory load (e.g. iZotope monolithic .vst3).
+    const auto lower = toLowerAscii (modulePath.string ());
+    return lower.find ("\\izotope\\") != std::string::npos;
+}
+
+bool pathHasVst3Extension (const std::filesystem::path& modulePath)
+{
+    return toLowerAscii (modulePath.extension ().string ()) == ".vst3";
+}
+
+#if SMTG_OS_LINUX
+//------------------------------------------------------------------------
+// Static pre-dlopen check of the binary Module::create would load: ELF class, byte order and
+// machine, then whether the loader can find each DT_NEEDED library. A wrong-architecture
+// build or a missing dependency fails inside dlopen anyway; here it costs a few page reads.
+// Only direct dependencies are checked, and anything that cannot be decided statically
+// ($PLATFORM/$LIB tokens, unreadable files) is left for dlopen to judge.
+
+constexpr unsigned char kHostElfClass = sizeof (void*) == 8 ? ELFCLASS64 : ELFCLASS32;
+constexpr unsigned char kHostElfData =
+    __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ ? ELFDATA2LSB : ELFDATA2MSB;
+
+#if defined(__x86_64__)
+constexpr uint16_t kHostElfMachine = EM_X86_64;
+#elif defined(__aarch64__)
+constexpr uint16_t kHostElfMachine = EM_AARCH64;
+#elif defined(__i386__)
+constexpr uint16_t kHostElfMachine = EM_386;
+#elif defined(__arm__)
+constexpr uint16_t kHostElfMachine = EM_ARM;
+#elif defined(__riscv)
+constexpr uint16_t kHostElfMachine = EM_RISCV;
+#elif defined(__powerpc64__)
+constexpr uint16_t kHostElfMachine = EM_PPC64;
+#else
+constexpr uint16_t kHostElfMachine = EM_NONE; // unknown: machine not checked
+#endif
+
+// Debian-style multiarch directory name (/usr/lib/<triplet>); 32-bit ARM is named after its
+// float ABI, not after the machine.
+#if defined(__x86_64__)
+constexpr const char* kHostMultiarch = "x86_64-linux-gnu";
+#elif defined(__aarch64__)
+constexpr const char* kHostMultiarch = "aarch64-linux-gnu";
+#elif defined(__i386__)
+constexpr const char* kHostMultiarch = "i386-linux-gnu";
+#elif defined(__arm__) && defined(__ARM_PCS_VFP)
+constexpr const char* kHostMultiarch = "arm-linux-gnueabihf";
+#elif defined(__arm__)
+constexpr const char* kHostMultiarch = "arm-linux-gnueabi";
+#elif defined(__riscv) && __riscv_xlen == 64
+constexpr const char* kHostMultiarch = "riscv64-linux-gnu";
+#elif defined(__powerpc64__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+constexpr const char* kHostMultiarch = "powerpc64le-linux-gnu";
+#elif defined(__powerpc64__)
+constexpr const char* kHostMultiarch = "powerpc64-linux-gnu";
+#else
+constexpr const char* kHostMultiarch = nullptr;
+#endif
+
+std::string elfMachineName (uint16_t machine)
+{
+    switch (machine)
+    {
+        case EM_X86_64: return "x86_64";
+        case EM_AARCH64: return "aarch64";
+        case EM_386: return "i386";
+        case EM_ARM: return "arm";
+        case EM_RISCV: return "riscv";
+        case EM_PPC64: return "ppc64";
+        default: return "machine " + std::to_string (machine);
+    }
+}
+
+// Empty if the identification and machine fields suit this process.
+std::string elfHeaderProblem (const char* data, size_t size)
+{
+    if (size < EI_NIDENT || std::memcmp (data, ELFMAG, SELFMAG) != 0)
+        return "not an ELF binary";
+    const auto elfClass = static_cast<unsigned char> (data[EI_CLASS]);
+    if (elfClass != ELFCLASS32 && elfClass != ELFCLASS64)
+        return "invalid ELF class";
+    if (elfClass != kHostElfClass)
+        return elfClass == ELFCLASS32 ? "32-bit ELF binary in a 64-bit scanner"
+                                      : "64-bit ELF binary in a 32-bit scanner";
+    if (static_cast<unsigned char> (data[EI_DATA]) != kHostElfData)
+        return "ELF binary has the wrong byte order";
+    if (size < sizeof (ElfW (Ehdr)))
+        return "truncated ELF header";
+
+    ElfW (Ehdr) header;
+    std::memcpy (&header, data, sizeof (header));
+    if (kHostElfMachine != EM_NONE && header.e_machine != kHostElfMachine)
+        return "built for " + elfMachineName (header.e_machine) + ", not " +
+               elfMachineName (kHostElfMachine);
+    return {};
+}
+
+// A library file the loader would accept: present, readable and built for this process.
+bool isCompatibleLibrary (const std::string& path)
+{
+    const int fd = ::open (path.c_str (), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    char header[sizeof (ElfW (Ehdr))];
+    const auto bytes = ::pread (fd, header, sizeof (header), 0);
+    ::close (fd);
+    return bytes > 0 && elfHeaderProblem (header, static_cast<size_t> (bytes)).empty ();
+}
+
+// soname -> path, from /etc/ld.so.cache. Reads glibc's current format, whether the file holds
+// only that or the legacy table first; without a readable cache the map is empty.
+const std::unordered_multimap<std::string, std::string>& ldSoCache ()
+{
+    static const auto cache = [] () {
+        std::unordered_multimap<std::string, std::string> entries;
+        const MappedFile mapped ("/etc/ld.so.cache");
+        if (!mapped.valid ())
+            return entries;
+
+        static constexpr std::string_view kMagic = "glibc-ld.so.cache1.1";
+        const size_t start = std::string_view (mapped.data (), mapped.size ()).find (kMagic);
+        if (start == std::string_view::npos)
+            return entries;
+
+        // Header: magic and version (20 bytes), nlibs, len_strings, flags, extension offset,
+        // reserved (48 bytes); then 24-byte entries {flags, key, value, osversion, hwcap}.
+        // String offsets count from the header.
+        constexpr size_t kHeaderSize = 48;
+        constexpr size_t kEntrySize = 24;
+        const char* base = mapped.data () + start;
+        const size_t available = mapped.size () - start;
+        uint32_t count = 0;
+        if (available < kHeaderSize)
+            return entries;
+        std::memcpy (&count, base + 20, sizeof (count));
+        if (count > (available - kHeaderSize) / kEntrySize)
+            return entries;
+
+        const auto stringAt = [base, available] (uint32_t offset) {
+            if (offset >= available)
+                return std::string ();
+            return std::string (base + offset, ::strnlen (base + offset, available - offset));
+        };
+        entries.reserve (count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            const char* entry = base + kHeaderSize + i * kEntrySize;
+            uint32_t key = 0;
+            uint32_t value = 0;
+            std::memcpy (&key, entry + 4, sizeof (key));
+            std::memcpy (&value, entry + 8, sizeof (value));
+            entries.emplace (stringAt (key), stringAt (value));
+        }
+        return entries;
+    }();
+    return cache;
+}
+
+// Splits a DT_RPATH/DT_RUNPATH list and expands $ORIGIN. Entries with other tokens are
+// returned empty, meaning "cannot tell".
+std::vector<std::string> expandSearchPath (const std::string& list, const std::string& origin)
+{
+    std::vector<std::string> dirs;
+    size_t start = 0;
+    while (start <= list.size ())
+    {
+        const size_t colon = (std::min) (list.find (':', start), list.size ());
+        std::string dir = list.substr (start, colon - start);
+        start = colon + 1;
+        if (dir.empty ())
+            continue;
+
+        for (const char* token : {"${ORIGIN}", "$ORIGIN"})
+        {
+            for (size_t at = dir.find (token); at != std::string::npos; at = dir.find (token))
+                dir.replace (at, std::strlen (token), origin);
+        }
+        if (dir.find ('$') != std::string::npos)
+            dir.clear ();
+        dirs.push_back (std::move (dir));
+    }
+    return dirs;
+}
+
+// A superset of the loader's built-in directories across distributions: glibc's multiarch
+// and lib64 layouts, and musl's default path or the one its /etc/ld-musl-<arch>.path sets. A
+// module is rejected when one of its libraries is in none of the places searched, so leaning
+// towards too many directories here is the safe side: a wrong "found" only defers to dlopen.
+const std::vector<std::string>& defaultLibraryDirs ()
+{
+    static const auto dirs = [] () {
+        std::vector<std::string> result;
+        if (kHostMultiarch != nullptr)
+        {
+            result.push_back (std::string ("/lib/") + kHostMultiarch);
+            result.push_back (std::string ("/usr/lib/") + kHostMultiarch);
+        }
+        for (const char* dir : {"/lib64", "/usr/lib64", "/lib", "/usr/local/lib", "/usr/lib"})
+            result.push_back (dir);
+
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator ("/etc", ec))
+        {
+            const auto fileName = entry.path ().filename ().string ();
+            if (fileName.compare (0, 8, "ld-musl-") != 0 || entry.path ().extension () != ".path")
+                continue;
+            std::ifstream in (entry.path ());
+            std::string line;
+            while (std::getline (in, line))
+            {
+                for (const auto& dir : expandSearchPath (line, {}))
+                {
+                    if (!dir.empty ())
+                        result.push_back (dir);
+                }
+            }
+        }
+        return result;
+    }();
+    return dirs;
+}
+
+// ld.so.cache and the default directories; the same for every module, so memoized.
+bool systemLibraryResolves (const std::string& name)
+{
+    static std::mutex mutex;
+    static std::unordered_map<std::string, bool> known;
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+        const auto it = known.find (name);
+        if (it != known.end ())
+            return it->second;
+    }
+
+    bool found = false;
+    const auto range = ldSoCache ().equal_range (name);
+    for (auto it = range.first; it != range.second && !found; ++it)
+        found = isCompatibleLibrary (it->second);
+
+    for (const auto& dir : defaultLibraryDirs ())
+    {
+        if (found)
+            break;
+        found = isCompatibleLibrary (dir + "/" + name);
+    }
+
+    std::lock_guard<std::mutex> lock (mutex);
+    known.emplace (name, found);
+    return found;
+}
+
+// dlopen reuses an object already in the process when its name matches.
+bool libraryAlreadyLoaded (const std::string& name)
+{
+    struct Search
+    {
+        const std::string* name;
+        bool found;
+    } search {&name, false};
+
+    ::dl_iterate_phdr (
+        [] (struct dl_phdr_info* info, size_t, void* data) {
+            auto* s = static_cast<Search*> (data);
+            const char* path = info->dlpi_name != nullptr ? info->dlpi_name : "";
+            const char* slash = std::strrchr (path, '/');
+            s->found = *s->name == (slash != nullptr ? slash + 1 : path);
+            return s->found ? 1 : 0;
+        },
+        &search);
+    return search.found;
+}
+
+// The loader's search order: DT_RPATH (only without DT_RUNPATH), LD_LIBRARY_PATH,
+// DT_RUNPATH, then ld.so.cache and the default directories.
+bool neededLibraryResolves (const std::string& name, const std::vector<std::string>& rpath,
+                            const std::vector<std::string>& runpath)
+{
+    if (name.find ('$') != std::string::npos)
+        return true;
+    if (name.find ('/') != std::string::npos)
+        return isCompatibleLibrary (name);
+
+    const char* env = std::getenv ("LD_LIBRARY_PATH");
+    const auto ldLibraryPath = expandSearchPath (env != nullptr ? env : "", {});
+    for (const auto* dirs : {&rpath, &ldLibraryPath, &runpath})
+    {
+        for (const auto& dir : *dirs)
+        {
+            if (dir.empty () || isCompatibleLibrary (dir + "/" + name))
+                return true;
+        }
+    }
+    return systemLibraryResolves (name) || libraryAlreadyLoaded (name);
+}
+
+// Why binary cannot be dlopened by this process; empty when nothing visible stops it.
+std::string elfLoadProblem (const std::filesystem::path& binary)
+{
+    const MappedFile mapped (binary);
+    if (!mapped.valid ())
+        return {};
+    const char* data = mapped.data ();
+    const size_t size = mapped.size ();
+
+    auto problem = elfHeaderProblem (data, size);
+    if (!problem.empty ())
+        return problem;
+
+    ElfW (Ehdr) header;
+    std::memcpy (&header, data, sizeof (header));
+    if (header.e_type != ET_DYN)
+        return "ELF binary is not a shared object";
+    if (header.e_phentsize != sizeof (ElfW (Phdr)) || header.e_phoff > size ||
+        (size - header.e_phoff) / sizeof (ElfW (Phdr)) < header.e_phnum)
+        return "truncated ELF program headers";
+
+    std::vector<ElfW (Phdr)> loads;
+    ElfW (Phdr) dynamic {};
+    for (size_t i = 0; i < header.e_phnum; ++i)
+    {
+        ElfW (Phdr) segment;
+        std::memcpy (&segment, data + header.e_phoff + i * sizeof (segment), sizeof (segment));
+        if (segment.p_type == PT_LOAD)
+            loads.push_back (segment);
+        else if (segment.p_type == PT_DYNAMIC)
+            dynamic = segment;
+    }
+    if (dynamic.p_type != PT_DYNAMIC || dynamic.p_offset > size)
+        return {}; // nothing to resolve
+
+    std::vector<size_t> needed;
+    size_t rpathAt = SIZE_MAX;
+    size_t runpathAt = SIZE_MAX;
+    ElfW (Addr) strtab = 0;
+    size_t strsz = 0;
+    const size_t dynamicEnd = (std::min) (size, size_t (dynamic.p_offset + dynamic.p_filesz));
+    for (size_t at = dynamic.p_offset; at + sizeof (ElfW (Dyn)) <= dynamicEnd;
+         at += sizeof (ElfW (Dyn)))
+    {
+        ElfW (Dyn) entry;
+        std::memcpy (&entry, data + at, sizeof (entry));
+        if (entry.d_tag == DT_NULL)
+            break;
+        switch (entry.d_tag)
+        {
+            case DT_NEEDED: needed.push_back (entry.d_un.d_val); break;
+            case DT_RPATH: rpathAt = entry.d_un.d_val; break;
+            case DT_RUNPATH: runpathAt = entry.d_un.d_val; break;
+            case DT_STRTAB: strtab = entry.d_un.d_ptr; break;
+            case DT_STRSZ: strsz = entry.d_un.d_val; break;
+            default: break;
+        }
+    }
+
+    // DT_STRTAB is a virtual address; the PT_LOAD segment holding it maps it to the file.
+    size_t strOffset = SIZE_MAX;
+    for (const auto& segment : loads)
+    {
+        if (strtab >= segment.p_vaddr && strtab - segment.p_vaddr < segment.p_filesz)
+            strOffset = segment.p_offset + (strtab - segment.p_vaddr);
+    }
+    if (strOffset > size || size - strOffset < strsz)
+        return {};
+    const auto stringAt = [&] (size_t offset) {
+        if (offset >= strsz)
+            return std::string ();
+        const char* text = data + strOffset + offset;
+        return std::string (text, ::strnlen (text, strsz - offset));
+    };
+
+    const auto origin = binary.parent_path ().string ();
+    const auto runpath =
+        runpathAt != SIZE_MAX ? expandSearchPath (stringAt (runpathAt), origin)
+                              : std::vector<std::string> ();
+    const auto rpath = runpathAt == SIZE_MAX && rpathAt != SIZE_MAX
+                           ? expandSearchPath (stringAt (rpathAt), origin)
+                           : std::vector<std::string> ();
+
+    std::string missing;
+    for (const auto offset : needed)
+    {
+        const auto name = stringAt (offset);
+        if (name.empty () || neededLibraryResolves (name, rpath, runpath))
+            continue;
+        missing += (missing.empty () ? "" : ", ") + name;
+    }
+    if (!missing.empty ())
+        return "missing libraries: " + missing;
+    return {};
+}
+
+// Checks the file Module::create would dlopen: a bundle's Contents/<uname -m>-linux/<name>.so,
+// or the path itself.
+std::string linuxModuleLoadProblem (const std::filesystem::path& modulePath)
+{
+    std::error_code ec;
+    if (!std::filesystem::is_directory (modulePath, ec))
+        return elfLoadProblem (modulePath);
+
+    static const std::string archDir = [] () {
+        struct utsname host {};
+        return ::uname (&host) == 0 ? std::string (host.machine) + "-linux" : std::string ();
+    }();
+    if (archDir.empty ())
+        return {};
+
+    const auto contents = modulePath / "Contents";
+    auto binary = contents / archDir / modulePath.stem ();
+    binary += ".so";
+    if (std::filesystem::is_regular_file (binary, ec))
+        return elfLoadProblem (binary);
+
+    std::vector<std::string> present;
+    for (const auto& entry : std::filesystem::directory_iterator (contents, ec))
+    {
+        const auto name = entry.path ().filename ().string ();
+        if (entry.is_directory (ec) && name != "Resources" && name != archDir)
+            present.push_back (name);
+    }
+    std::sort (present.begin (), present.end ());
+
+    std::string problem = "bundle has no " + archDir + " binary";
+    for (size_t i = 0; i < present.size (); ++i)
+        problem += (i == 0 ? " (has " : ", ") + present[i];
+    return present.empty () ? problem : problem + ")";
+}
+#endif // SMTG_OS_LINUX
+
+} // anonymous
+
+//------------------------------------------------------------------------
+ModuleAnalysis analyzeModule (const std::filesystem::path& modulePath)
+{
+    ModuleAnalysis analysis;
+    analysis.analyzed = true;
+    analysis.headlessUnsafeVendor = pathSuggestsHeadlessUnsafeVendor (modulePath);
+
+    std::error_code ec;
+    if (std::filesystem::is_directory (modulePath, ec))
+    {
+        inspectBundle (modulePath, analysis);
+    }
+    else if (std::filesystem::is_regular_file (modulePath, ec))
+    {
+        const auto size = std::filesystem::file_size (modulePath, ec);
+        if (!ec)
+            analysis.moduleSize = size;
+        if (pathHasVst3Extension (modulePath))
+            analysis.licenseMarkers = monolithicModuleHasLicenseMarkers (modulePath);
+    }
+
+#if SMTG_OS_LINUX
+    analysis.binaryProblem = linuxModuleLoadProblem (modulePath);
+#endif
+    return analysis;
+}
+
+bool bufferHasLicenseMarkers (const char* data, size_t size)
+{
+    return binaryChunkHasLicenseMarker (data, size);
+}
+
+//------------------------------------------------------------------------
+namespace {
+
+// With one job the log keeps its two-line form: "[i/n] scanning: <path>" before the load and
+// "  -> <result>" after it. Parallel workers finish out of order, so there each plugin gets one
+// line, "[i/n] <path> -> <result>", written once its result is in.
+std::string describeResult (const PluginInfo& info)
+{
+    if (info.isValid)
+        return "OK: " + info.name + " (" + info.vendor + ")";
+    if (info.missingLicense)
+        return "missing license (skipped)";
+    if (info.loadFailed && info.scanSource == "skipped")
+        return "failed (skipped)";
+    if (info.loadTimedOut)
+        return "timed out";
+    return "failed: " + info.errorMessage;
+}
+
+void logProgress (const ScanOptions& options, size_t index, size_t total,
+                  const std::string& path, const char* phase)
+{
+    if (options.quiet)
+        return;
+
+    std::ostringstream line;
+    line << "[" << index << "/" << total << "] " << phase << ": " << path;
+    logLine (line.str ());
+}
+
+void logPluginResult (const ScanOptions& options, const PluginInfo& info)
+{
+    if (options.quiet)
+        return;
+
+    logLine ("  -> " + describeResult (info));
+}
+
+void logPluginResult (const ScanOptions& options, size_t index, size_t total,
+                      const std::string& path, const PluginInfo& info)
+{
+    if (options.quiet)
+        return;
+
+    std::ostringstream line;
+    line << "[" << index << "/" << total << "] " << path << " -> " << describeResult (info);
+    logLine (line.str ());
+}
+
+//------------------------------------------------------------------------
+constexpr const char* kVstAudioEffectClassName = "Audio Module Class";
+
+bool isAudioEffectCategory (const std::string& category)
+{
+    return category == kVstAudioEffectClassName;
+}
+
+//------------------------------------------------------------------------
+#if SMTG_OS_WINDOWS
+constexpr const char* kVst3Extension = ".vst3";
+#elif SMTG_OS_MACOS
+constexpr const char* kVst3Extension = ".vst3";
+constexpr const char* kBundleExtension = ".bundle";
+#elif SMTG_OS_LINUX
+constexpr const char* kVst3Extension = ".vst3";
+constexpr const char* kSharedLibExtension = ".so";
+#endif
+
+//------------------------------------------------------------------------
+// A file's identity independent of the path that reached it: (st_dev, st_ino) on POSIX,
+// (volume serial, file index) on Windows. Symlinks are followed, so a link and its target,
+// and two hard links, compare equal.
+struct FileId
+{
+    uint64_t device {0};
+    uint64_t index {0};
+
+    bool operator== (const FileId& other) const
+    {
+        return device == other.device && index == other.index;
+    }
+};
+
+struct FileIdHash
+{
+    size_t operator() (const FileId& id) const
+    {
+        return std::hash<uint64_t> () (id.index * 0x9E3779B97F4A7C15ull ^ id.device);
+    }
+};
+
+bool fileId (const std::filesystem::path& path, FileId& id)
+{
+#if SMTG_OS_WINDOWS
+    // FILE_FLAG_BACKUP_SEMANTICS is what lets CreateFile open a directory.
+    const HANDLE file = CreateFileW (path.c_str (), 0,
+                                     FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                     nullptr, OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS, nullptr);
+    if (file == INVALID_HANDLE_VALUE)
+        return false;
+    BY_HANDLE_FILE_INFORMATION fileInfo {};
+    const bool ok = GetFileInformationByHandle (file, &fileInfo) != 0;
+    CloseHandle (file);
+    if (!ok)
+        return false;
+    id.device = fileInfo.dwVolumeSerialNumber;
+    id.index = (uint64_t (fileInfo.nFileIndexHigh) << 32) | fileInfo.nFileIndexLow;
+    return true;
+#else
+    struct stat st {};
+    if (::stat (path.c_str (), &st) != 0)
+        return false;
+    id.device = static_cast<uint64_t> (st.st_dev);
+    id.index = static_cast<uint64_t> (st.st_ino);
+    return true;
+#endif
+}
+
+bool isPathSeparator (char c)
+{
+#if SMTG_OS_WINDOWS
+    return c == '/' || c == '\\';
+#else
+    return c == '/';
+#endif
+}
+
+bool isSameOrBelow (const std::string& path, const std::string& dir)
+{
+    if (dir.empty () || path.compare (0, dir.size (), dir) != 0)
+        return false;
+    return path.size () == dir.size () || isPathSeparator (dir.back ()) ||
+           isPathSeparator (path[dir.size ()]);
+}
+
+size_t pathDepth (const std::string& path)
+{
+    return static_cast<size_t> (std::count_if (path.begin (), path.end (), isPathSeparator));
+}
+
+// How many components of path are symlinks (each prefix is lstat'ed).
+size_t symlinksInPath (const std::string& path)
+{
+    size_t links = 0;
+    std::filesystem::path prefix;
+    for (const auto& part : std::filesystem::path (path))
+    {
+        prefix /= part;
+        std::error_code ec;
+        if (std::filesystem::is_symlink (std::filesystem::symlink_status (prefix, ec)))
+            ++links;
+    }
+    return links;
+}
+
+//------------------------------------------------------------------------
+enum class EntryKind
+{
+    other,
+    module,
+    directory,
+};
+
+// Classifies a directory entry from the file type cached by the directory read (d_type on
+// POSIX, FindNextFile data on Windows). Only a directory with a bundle extension costs an extra
+// stat, to confirm Contents/.
+EntryKind classifyEntry (const std::filesystem::directory_entry& entry)
+{
+    std::error_code ec;
+    const auto& path = entry.path ();
+
+    if (entry.is_directory (ec))
+    {
+        const auto ext = path.extension ().string ();
+#if SMTG_OS_MACOS
+        const bool bundleExt = ext == kVst3Extension || ext == kBundleExtension;
+#else
+        const bool bundleExt = ext == kVst3Extension;
+#endif
+        if (bundleExt && std::filesystem::exists (path / "Contents", ec))
+            return EntryKind::module;
+        return EntryKind::directory;
+    }
+
+#if SMTG_OS_WINDOWS
+    // Legacy / monolithic Windows VST3: single .vst3 file (DLL), not a bundle folder
+    if (path.extension () == kVst3Extension && entry.is_regular_file (ec))
+        return EntryKind::module;
+#elif SMTG_OS_LINUX
+    if (path.extension () == kSharedLibExtension && entry.is_regular_file (ec))
+        return EntryKind::module;
+#endif
+
+    return EntryKind::other;
+}
+
+//------------------------------------------------------------------------
+// Work-stealing directory walk. Each thread pushes subdirectories onto its own deque and
+// pops from the back (depth first, warm dentries); idle threads steal from the front of
+// someone else's deque, which hands them the shallowest and usually largest subtrees.
+//
+// Directories and modules are keyed by FileId, not path. A directory reached a second time (a
+// symlinked vendor folder, or a link back up the tree) is not walked again; modules reached
+// through several paths (hard links, symlinked bundles) come out as one entry with the other
+// paths as aliases.
+class DirectoryWalker
+{
+public:
+    explicit DirectoryWalker (unsigned threads)
+    {
+        for (unsigned t = 0; t < (std::max) (1u, threads); ++t)
+            queues.push_back (std::make_unique<WorkQueue> ());
+    }
+
+    std::vector<DiscoveredModule> run (const std::filesystem::path& root)
+    {
+        FileId rootId;
+        if (fileId (root, rootId))
+            dirs.emplace (rootId, root.string ());
+
+        std::vector<std::vector<Found>> found (queues.size ());
+        push (0, root);
+
+        std::vector<std::thread> threads;
+        for (size_t t = 1; t < queues.size (); ++t)
+            threads.emplace_back ([this, t, &found] () { work (t, found[t]); });
+        work (0, found[0]);
+        for (auto& thread : threads)
+            thread.join ();
+
+        return collect (found);
+    }
+
+private:
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<std::filesystem::path> dirs;
+    };
+
+    struct Found
+    {
+        std::string path;
+        FileId id;
+        bool hasId {false};
+    };
+
+    // Groups the modules by FileId. A module below a directory that was skipped as a second
+    // path to a walked one also gets that path (one level; links inside links are not chased).
+    // The primary path is the one through the fewest symlinks, then the shallowest, then the
+    // lexicographically first, so the choice does not depend on which thread got where first.
+    std::vector<DiscoveredModule> collect (std::vector<std::vector<Found>>& found)
+    {
+        std::unordered_map<FileId, size_t, FileIdHash> byId;
+        std::vector<std::vector<std::string>> groups;
+        for (auto& part : found)
+        {
+            for (auto& module : part)
+            {
+                if (module.hasId)
+                {
+                    const auto inserted = byId.emplace (module.id, groups.size ());
+                    if (!inserted.second)
+                    {
+                        groups[inserted.first->second].push_back (std::move (module.path));
+                        continue;
+                    }
+                }
+                groups.push_back ({std::move (module.path)});
+            }
+        }
+
+        for (const auto& alias : aliasDirs)
+        {
+            const auto& target = alias.second;
+            for (auto& paths : groups)
+            {
+                const size_t count = paths.size ();
+                for (size_t i = 0; i < count; ++i)
+                {
+                    if (isSameOrBelow (paths[i], target) && paths[i].size () > target.size ())
+                        paths.push_back (alias.first + paths[i].substr (target.size ()));
+                }
+            }
+        }
+
+        std::vector<DiscoveredModule> modules;
+        modules.reserve (groups.size ());
+        for (auto& paths : groups)
+        {
+            if (paths.size () > 1)
+            {
+                std::sort (paths.begin (), paths.end ());
+                paths.erase (std::unique (paths.begin (), paths.end ()), paths.end ());
+                std::vector<std::pair<size_t, size_t>> rank;
+                for (const auto& path : paths)
+                    rank.emplace_back (symlinksInPath (path), pathDepth (path));
+                std::vector<size_t> order (paths.size ());
+                for (size_t i = 0; i < order.size (); ++i)
+                    order[i] = i;
+                std::stable_sort (order.begin (), order.end (), [&rank] (size_t a, size_t b) {
+                    return rank[a] < rank[b];
+                });
+                std::swap (paths.front (), paths[order.front ()]);
+            }
+
+            DiscoveredModule module;
+            module.path = std::move (paths.front ());
+            module.aliases.assign (std::make_move_iterator (paths.begin () + 1),
+                                   std::make_move_iterator (paths.end ()));
+            std::sort (module.aliases.begin (), module.aliases.end ());
+            modules.push_back (std::move (module));
+        }
+        std::sort (modules.begin (), modules.end (),
+                   [] (const DiscoveredModule& a, const DiscoveredModule& b) {
+                       return a.path < b.path;
+                   });
+        return modules;
+    }
+
+    // Claims a directory for walking. False if its FileId was claimed before: the path is then
+    // kept as an alias of the first one, unless it lies inside it (a cycle, dropped).
+    bool claimDirectory (const std::filesystem::path& dir)
+    {
+        FileId id;
+        if (!fileId (dir, id))
+            return true;
+
+        auto path = dir.string ();
+        std::lock_guard<std::mutex> lock (dirsMutex);
+        const auto inserted = dirs.emplace (id, path);
+        if (inserted.second)
+            return true;
+        if (!isSameOrBelow (path, inserted.first->second))
+            aliasDirs.emplace_back (std::move (path), inserted.first->second);
+        return false;
+    }
+
+    // queued is raised before the directory is visible in a deque, so a thief that takes it at
+    // once can never decrement the counter below zero.
+    void push (size_t self, std::filesystem::path dir)
+    {
+        ++pending;
+        {
+            std::lock_guard<std::mutex> lock (idleMutex);
+            ++queued;
+        }
+        {
+            std::lock_guard<std::mutex> lock (queues[self]->mutex);
+            queues[self]->dirs.push_back (std::move (dir));
+        }
+        idle.notify_one ();
+    }
+
+    bool take (size_t self, std::filesystem::path& dir)
+    {
+        for (size_t n = 0; n < queues.size (); ++n)
+        {
+            const size_t victim = (self + n) % queues.size ();
+            auto& queue = *queues[victim];
+            std::lock_guard<std::mutex> lock (queue.mutex);
+            if (queue.dirs.empty ())
+                continue;
+            if (victim == self)
+            {
+                dir = std::move (queue.dirs.back ());
+                queue.dirs.pop_back ();
+            }
+            else
+            {
+                dir = std::move (queue.dirs.front ());
+                queue.dirs.pop_front ();
+            }
+            std::lock_guard<std::mutex> idleLock (idleMutex);
+            --queued;
+            return true;
+        }
+        return false;
+    }
+
+    void work (size_t self, std::vector<Found>& found)
+    {
+        std::filesystem::path dir;
+        for (;;)
+        {
+            if (!take (self, dir))
+            {
+                std::unique_lock<std::mutex> lock (idleMutex);
+                idle.wait (lock, [this] () { return queued > 0 || pending == 0; });
+                if (pending == 0)
+                    return;
+                continue;
+            }
+
+            visit (self, dir, found);
+
+            if (--pending == 0)
+            {
+                std::lock_guard<std::mutex> lock (idleMutex);
+                idle.notify_all ();
+            }
+        }
+    }
+
+    void visit (size_t self, const std::filesystem::path& dir, std::vector<Found>& found)
+    {
+        std::error_code ec;
+        std::filesystem::directory_iterator it (
+            dir, std::filesystem::directory_options::skip_permission_denied, ec);
+        // As in the serial walk, an entry that fails costs only itself: the error is cleared and
+        // the walk goes on for as long as the iterator can still advance.
+        for (const std::filesystem::directory_iterator end; it != end; it.increment (ec))
+        {
+            if (ec)
+            {
+                ec.clear ();
+                continue;
+            }
+            switch (classifyEntry (*it))
+            {
+                case EntryKind::module:
+                {
+                    Found module;
+                    module.path = it->path ().string ();
+                    module.hasId = fileId (it->path (), module.id);
+                    found.push_back (std::move (module));
+                    break;
+                }
+                case EntryKind::directory:
+                    if (claimDirectory (it->path ()))
+                        push (self, it->path ());
+                    break;
+                case EntryKind::other: break;
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::atomic<size_t> pending {0}; // directories queued or being visited
+    size_t queued {0};               // directories waiting in some deque; guarded by idleMutex
+    std::mutex idleMutex;
+    std::condition_variable idle;
+
+    std::mutex dirsMutex;
+    std::unordered_map<FileId, std::string, FileIdHash> dirs;   // first path that reached it
+    std::vector<std::pair<std::string, std::string>> aliasDirs; // (skipped path, walked path)
+};
+
+} // anonymous
+
+//------------------------------------------------------------------------
+void setLogStream (std::ostream& out)
+{
+    std::lock_guard<std::recursive_mutex> lock (logMutex);
+    logOut = &out;
+}
+
+//------------------------------------------------------------------------
+std::vector<DiscoveredModule> discoverModules (const std::string& directory, unsigned threads)
+{
+    std::vector<DiscoveredModule> modules;
+
+    try
+    {
+        std::error_code ec;
+        if (!std::filesystem::exists (directory, ec))
+            return modules;
+
+        if (threads == 0)
+            threads = (std::max) (1u, std::thread::hardware_concurrency ());
+        modules = DirectoryWalker (threads).run (std::filesystem::path (directory));
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error scanning directory: " << e.what () << std::endl;
+    }
+
+    return modules;
+}
+
+//------------------------------------------------------------------------
+std::vector<std::string> findVSTFiles (const std::string& directory, unsigned threads)
+{
+    std::vector<std::string> vstFiles;
+    for (auto& module : discoverModules (directory, threads))
+        vstFiles.push_back (std::move (module.path));
+    return vstFiles;
+}
+
+//------------------------------------------------------------------------
+namespace {
+
+uint32_t elapsedMicros (std::chrono::steady_clock::time_point since)
+{
+    const int64_t us = std::chrono::duration_cast<std::chrono::microseconds> (
+                           std::chrono::steady_clock::now () - since)
+                           .count ();
+    return static_cast<uint32_t> ((std::min) (us, int64_t (UINT32_MAX)));
+}
+
+// Fills the top-level fields from the primary class in info.classes, which must not be empty.
+void fillPluginInfoFromClasses (PluginInfo& info)
+{
+    const PluginClassInfo* primary = &info.classes.front ();
+    for (const auto& entry : info.classes)
+    {
+        if (isAudioEffectCategory (entry.category))
+        {
+            primary = &entry;
+            break;
+        }
+    }
+
+    info.name = primary->name;
+    info.vendor = primary->vendor;
+    info.version = primary->version;
+    info.categories = primary->subCategories;
+    info.cid = primary->cid;
+    info.sdkVersion = primary->sdkVersion;
+    info.cardinality = primary->cardinality;
+    info.flags = primary->flags;
+    info.isValid = true;
+}
+
+PluginClassInfo classInfoFromHostingClass (const VST3::Hosting::ClassInfo& classInfo)
+{
+    PluginClassInfo entry;
+    entry.name = classInfo.name ();
+    entry.category = classInfo.category ();
+    entry.subCategories = classInfo.subCategories ();
+    entry.cid = classInfo.ID ().toString ();
+    entry.vendor = classInfo.vendor ();
+    entry.version = classInfo.version ();
+    entry.sdkVersion = classInfo.sdkVersion ();
+    entry.cardinality = classInfo.cardinality ();
+    entry.flags = classInfo.classFlags ();
+    return entry;
+}
+
+} // anonymous
+
+//------------------------------------------------------------------------
+PluginInfo scanPluginFromFactory (const std::string& pluginPath)
+{
+    PluginInfo info;
+    info.path = pluginPath;
+    info.isValid = false;
+
+    try
+    {
+        std::string errorStr;
+        auto started = std::chrono::steady_clock::now ();
+        auto module = VST3::Hosting::Module::create (pluginPath, errorStr);
+        info.timings.moduleLoadUs = elapsedMicros (started);
+
+        if (!module)
+        {
+            info.errorMessage = errorStr;
+            return info;
+        }
+
+        started = std::chrono::steady_clock::now ();
+        auto factory = module->getFactory ();
+        auto classInfos = factory.classInfos ();
+        info.timings.classInfoUs = elapsedMicros (started);
+
+        if (classInfos.empty ())
+        {
+            info.errorMessage = "No plugin classes found";
+            return info;
+        }
+
+        info.classes.reserve (classInfos.size ());
+        for (const auto& classInfo : classInfos)
+            info.classes.push_back (classInfoFromHostingClass (classInfo));
+
+        fillPluginInfoFromClasses (info);
+        info.scanSource = "factory";
+    }
+    catch (const std::exception& e)
+    {
+        info.errorMessage = e.what ();
+    }
+    catch (...)
+    {
+        info.errorMessage = "Unknown exception while loading plugin";
+    }
+
+    return info;
+}
+
+//------------------------------------------------------------------------
+namespace {
+
+// Quotes one argument the way CommandLineToArgvW and the CRT split it: backslashes are literal
+// unless they precede a quote, so only those runs (and the one before the closing quote) are
+// doubled, and a path like C:\Plugins\x.vst3 passes through as is.
+std::string quoteArg (const std::string& arg)
+{
+    std::string out = "\"";
+    size_t backslashes = 0;
+    for (char c : arg)
+    {
+        if (c == '\\')
+        {
+            ++backslashes;
+            continue;
+        }
+        out.append (c == '"' ? backslashes * 2 + 1 : backslashes, '\\');
+        backslashes = 0;
+        out += c;
+    }
+    out.append (backslashes * 2, '\\');
+    out += "\"";
+    return out;
+}
+
+//------------------------------------------------------------------------
+// Length-prefixed little-endian PluginInfo encoding, shared by the isolated worker pipe and
+// the on-disk scan cache. Not a stable exchange format; JSON is.
+void appendWireU32 (std::string& out, uint32_t value)
+{
+    char bytes[4];
+    std::memcpy (bytes, &value, sizeof (bytes));
+    out.append (bytes, sizeof (bytes));
+}
+
+void appendWireU64 (std::string& out, uint64_t value)
+{
+    char bytes[8];
+    std::memcpy (bytes, &value, sizeof (bytes));
+    out.append (bytes, sizeof (bytes));
+}
+
+void appendWireString (std::string& out, const std::string& value)
+{
+    appendWireU32 (out, static_cast<uint32_t> (value.size ()));
+    out += value;
+}
+
+bool readWireU32 (const std::string& in, size_t& pos, uint32_t& value)
+{
+    if (in.size () - pos < sizeof (value))
+        return false;
+    std::memcpy (&value, in.data () + pos, sizeof (value));
+    pos += sizeof (value);
+    return true;
+}
+
+bool readWireU64 (const std::string& in, size_t& pos, uint64_t& value)
+{
+    if (in.size () - pos < sizeof (value))
+        return false;
+    std::memcpy (&value, in.data () + pos, sizeof (value));
+    pos += sizeof (value);
+    return true;
+}
+
+// Reads an element count and rejects it when the remaining input cannot hold that many
+// elements, so a corrupt count never turns into a huge allocation.
+bool readWireCount (const std::string& in, size_t& pos, uint32_t& count, size_t minElementSize)
+{
+    return readWireU32 (in, pos, count) && count <= (in.size () - pos) / minElementSize;
+}
+
+bool readWireString (const std::string& in, size_t& pos, std::string& value)
+{
+    uint32_t len = 0;
+    if (!readWireU32 (in, pos, len) || in.size () - pos < len)
+        return false;
+    value.assign (in.data () + pos, len);
+    pos += len;
+    return true;
+}
+
+std::string serializePluginInfo (const PluginInfo& info)
+{
+    std::string out;
+    for (const auto* field : {&info.path, &info.name, &info.vendor, &info.version, &info.cid,
+                              &info.sdkVersion, &info.errorMessage, &info.scanSource})
+        appendWireString (out, *field);
+    appendWireU32 (out, static_cast<uint32_t> (info.categories.size ()));
+    for (const auto& category : info.categories)
+        appendWireString (out, category);
+    appendWireU32 (out, static_cast<uint32_t> (info.cardinality));
+    appendWireU32 (out, info.flags);
+    appendWireU32 (out, (info.isValid ? 1u : 0u) | (info.missingLicense ? 2u : 0u) |
+                            (info.loadFailed ? 4u : 0u) | (info.loadTimedOut ? 8u : 0u));
+
+    const auto& analysis = info.analysis;
+    appendWireU32 (out, (analysis.analyzed ? 1u : 0u) | (analysis.licenseMarkers ? 2u : 0u) |
+                            (analysis.headlessUnsafeVendor ? 4u : 0u));
+    appendWireU64 (out, analysis.moduleSize);
+    appendWireU32 (out, static_cast<uint32_t> (analysis.licenseWrappers.size ()));
+    for (const auto& wrapper : analysis.licenseWrappers)
+        appendWireString (out, wrapper);
+    appendWireString (out, analysis.binaryProblem);
+
+    appendWireU32 (out, static_cast<uint32_t> (info.classes.size ()));
+    for (const auto& entry : info.classes)
+    {
+        for (const auto* field : {&entry.name, &entry.category, &entry.cid, &entry.vendor,
+                                  &entry.version, &entry.sdkVersion})
+            appendWireString (out, *field);
+        appendWireU32 (out, static_cast<uint32_t> (entry.subCategories.size ()));
+        for (const auto& sub : entry.subCategories)
+            appendWireString (out, sub);
+        appendWireU32 (out, static_cast<uint32_t> (entry.cardinality));
+        appendWireU32 (out, entry.flags);
+    }
+
+    const auto& t = info.timings;
+    for (const uint32_t us : {t.cacheUs, t.analyzeUs, t.moduleLoadUs, t.classInfoUs, t.workerUs,
+                              t.totalUs})
+        appendWireU32 (out, us);
+    return out;
+}
+
+bool deserializePluginInfo (const std::string& in, PluginInfo& info)
+{
+    size_t pos = 0;
+    for (auto* field : {&info.path, &info.name, &info.vendor, &info.version, &info.cid,
+                        &info.sdkVersion, &info.errorMessage, &info.scanSource})
+    {
+        if (!readWireString (in, pos, *field))
+            return false;
+    }
+
+    uint32_t count = 0;
+    if (!readWireCount (in, pos, count, 4))
+        return false;
+    info.categories.resize (count);
+    for (auto& category : info.categories)
+    {
+        if (!readWireString (in, pos, category))
+            return false;
+    }
+
+    uint32_t cardinality = 0, bits = 0;
+    if (!readWireU32 (in, pos, cardinality) || !readWireU32 (in, pos, info.flags) ||
+        !readWireU32 (in, pos, bits))
+        return false;
+    info.cardinality = static_cast<int32_t> (cardinality);
+    info.isValid = (bits & 1u) != 0;
+    info.missingLicense = (bits & 2u) != 0;
+    info.loadFailed = (bits & 4u) != 0;
+    info.loadTimedOut = (bits & 8u) != 0;
+
+    auto& analysis = info.analysis;
+    if (!readWireU32 (in, pos, bits) || !readWireU64 (in, pos, analysis.moduleSize) ||
+        !readWireCount (in, pos, count, 4))
+        return false;
+    analysis.analyzed = (bits & 1u) != 0;
+    analysis.licenseMarkers = (bits & 2u) != 0;
+    analysis.headlessUnsafeVendor = (bits & 4u) != 0;
+    analysis.licenseWrappers.resize (count);
+    for (auto& wrapper : analysis.licenseWrappers)
+    {
+        if (!readWireString (in, pos, wrapper))
+            return false;
+    }
+    if (!readWireString (in, pos, analysis.binaryProblem))
+        return false;
+
+    // Six strings, a subcategory count, cardinality and flags: at least 36 bytes per class.
+    if (!readWireCount (in, pos, count, 36))
+        return false;
+    info.classes.resize (count);
+    for (auto& entry : info.classes)
+    {
+        for (auto* field : {&entry.name, &entry.category, &entry.cid, &entry.vendor,
+                            &entry.version, &entry.sdkVersion})
+        {
+            if (!readWireString (in, pos, *field))
+                return false;
+        }
+        uint32_t subCount = 0;
+        if (!readWireCount (in, pos, subCount, 4))
+            return false;
+        entry.subCategories.resize (subCount);
+        for (auto& sub : entry.subCategories)
+        {
+            if (!readWireString (in, pos, sub))
+                return false;
+        }
+        if (!readWireU32 (in, pos, cardinality) || !readWireU32 (in, pos, entry.flags))
+            return false;
+        entry.cardinality = static_cast<int32_t> (cardinality);
+    }
+
+    auto& t = info.timings;
+    for (auto* us : {&t.cacheUs, &t.analyzeUs, &t.moduleLoadUs, &t.classInfoUs, &t.workerUs,
+                     &t.totalUs})
+    {
+        if (!readWireU32 (in, pos, *us))
+            return false;
+    }
+    return true;
+}
+
+#if SMTG_OS_WINDOWS
+// The worker is vst_scanner.exe run with --worker: this executable, unless a host that links
+// the library names one. Paths go on the child's command line, not in the environment, which
+// is shared by every scan worker thread.
+PluginInfo scanPluginFromFactoryIsolated (const std::string& pluginPath, unsigned timeoutSec,
+                                          const std::string& workerExecutable,
+                                          ScanTrace::Track* trace = nullptr)
+{
+    PluginInfo fallback;
+    fallback.path = pluginPath;
+    fallback.isValid = false;
+
+    std::string exePath = workerExecutable;
+    if (exePath.empty ())
+    {
+        char ownPath[MAX_PATH] {};
+        if (GetModuleFileNameA (nullptr, ownPath, MAX_PATH) == 0)
+        {
+            fallback.errorMessage = "Could not resolve scanner executable path";
+            return fallback;
+        }
+        exePath = ownPath;
+    }
+
+    // Parallel workers may start children within one clock tick; the counter keeps names apart.
+    static std::atomic<unsigned> workerSerial {0};
+    const auto tempDir = std::filesystem::temp_directory_path ();
+    std::ostringstream tempName;
+    tempName << "vst_scan_worker_" << GetCurrentProcessId () << "_" << workerSerial++ << "_"
+             << std::chrono::steady_clock::now ().time_since_epoch ().count () << ".json";
+    const auto outPath = tempDir / tempName.str ();
+
+    std::ostringstream cmd;
+    cmd << quoteArg (exePath) << " --worker " << quoteArg (pluginPath) << " -o "
+        << quoteArg (outPath.string ()) << " -q";
+    std::string cmdStr = cmd.str ();
+    std::vector<char> cmdBuf (cmdStr.begin (), cmdStr.end ());
+    cmdBuf.push_back ('\0');
+
+    STARTUPINFOA si {};
+    si.cb = sizeof (si);
+    si.dwFlags = STARTF_USESHOWWINDOW;
+    si.wShowWindow = SW_HIDE;
+
+    PROCESS_INFORMATION pi {};
+
+    if (!CreateProcessA (nullptr, cmdBuf.data (), nullptr, nullptr, FALSE, CREATE_NO_WINDOW,
+                         nullptr, nullptr, &si, &pi))
+    {
+        fallback.errorMessage = "Failed to start isolated plugin scan worker";
+        return fallback;
+    }
+
+    const DWORD timeoutMs = timeoutSec * 1000u;
+    const DWORD waitResult = WaitForSingleObject (pi.hProcess, timeoutMs);
+
+    if (waitResult == WAIT_TIMEOUT)
+    {
+        const auto killStarted = std::chrono::steady_clock::now ();
+        TerminateProcess (pi.hProcess, 1);
+        if (trace)
+            trace->span ("kill", killStarted, std::chrono::steady_clock::now ());
+        CloseHandle (pi.hProcess);
+        CloseHandle (pi.hThread);
+        std::error_code ec;
+        std::filesystem::remove (outPath, ec);
+        fallback.errorMessage =
+            "Timed out loading plugin (hung initializer or modal UI)";
+        fallback.loadTimedOut = true;
+        classifyPluginFailure (fallback);
+        return fallback;
+    }
+
+    DWORD exitCode = 1;
+    GetExitCodeProcess (pi.hProcess, &exitCode);
+    CloseHandle (pi.hProcess);
+    CloseHandle (pi.hThread);
+
+    std::vector<PluginInfo> parsed;
+    std::error_code ec;
+    for (int attempt = 0; attempt < 20; ++attempt)
+    {
+        if (std::filesystem::exists (outPath, ec))
+        {
+            parsed = VSTScanner::parseExistingJSON (outPath.string ());
+            if (!parsed.empty ())
+                break;
+        }
+        Sleep (25);
+    }
+
+    std::filesystem::remove (outPath, ec);
+
+    if (!parsed.empty ())
+        return parsed.front ();
+
+    if (!std::filesystem::exists (outPath, ec))
+    {
+        std::ostringstream msg;
+        msg << "Isolated worker exited without result (exit code " << exitCode
+            << "; plugin may have crashed on load)";
+        fallback.errorMessage = msg.str ();
+    }
+    else
+    {
+        fallback.errorMessage = "Could not parse worker scan result (exit code " +
+                               std::to_string (exitCode) + ")";
+    }
+    classifyPluginFailure (fallback);
+    return fallback;
+}
+#endif
+
+#if SMTG_OS_LINUX
+//------------------------------------------------------------------------
+// Pre-forked scan workers. Each child is forked once, then reads plugin paths from its end of
+// a socketpair and answers with one serialized PluginInfo per request, so a crash or hang in
+// Module::create only costs that child. Children are forked without exec, but never from the
+// scanner itself once it runs threads: a single-threaded fork server forks them all (see
+// WorkerForkServer), so no child inherits a loader or allocator lock another thread held.
+constexpr unsigned kIsolatedWorkerRecycleAfter = 64; // bounds leaks from plugins that never unload
+
+// Reads or writes exactly size bytes. A deadline of time_point::max () waits forever.
+// Returns 1 on success, 0 on EOF, -1 on error and -2 when the deadline passes.
+int transferAll (int fd, char* data, size_t size, bool writing,
+                 std::chrono::steady_clock::time_point deadline)
+{
+    while (size > 0)
+    {
+        int waitMs = -1;
+        if (deadline != std::chrono::steady_clock::time_point::max ())
+        {
+            const auto left = std::chrono::duration_cast<std::chrono::milliseconds> (
+                deadline - std::chrono::steady_clock::now ());
+            if (left.count () <= 0)
+                return -2;
+            waitMs = static_cast<int> (
+                (std::min) (left.count (), std::chrono::milliseconds::rep (60000)));
+        }
+
+        pollfd pfd {fd, static_cast<short> (writing ? POLLOUT : POLLIN), 0};
+        const int ready = ::poll (&pfd, 1, waitMs);
+        if (ready < 0 && errno == EINTR)
+            continue;
+        if (ready < 0)
+            return -1;
+        if (ready == 0)
+            continue;
+
+        const ssize_t n = writing ? ::send (fd, data, size, MSG_NOSIGNAL) : ::recv (fd, data, size, 0);
+        if (n < 0 && (errno == EINTR || errno == EAGAIN))
+            continue;
+        if (n < 0)
+            return -1;
+        if (n == 0)
+            return 0;
+        data += n;
+        size -= static_cast<size_t> (n);
+    }
+    return 1;
+}
+
+int sendFrame (int fd, const std::string& payload)
+{
+    std::string frame;
+    frame.reserve (payload.size () + 4);
+    appendWireU32 (frame, static_cast<uint32_t> (payload.size ()));
+    frame += payload;
+    return transferAll (fd, &frame[0], frame.size (), true,
+                        std::chrono::steady_clock::time_point::max ());
+}
+
+int receiveFrame (int fd, std::string& payload, std::chrono::steady_clock::time_point deadline)
+{
+    char header[4];
+    int rc = transferAll (fd, header, sizeof (header), false, deadline);
+    if (rc != 1)
+        return rc;
+    uint32_t len = 0;
+    std::memcpy (&len, header, sizeof (len));
+    payload.resize (len);
+    return len == 0 ? 1 : transferAll (fd, &payload[0], len, false, deadline);
+}
+
+[[noreturn]] void runIsolatedWorkerChild (int fd)
+{
+    // Plugins love to print; keep their chatter out of the JSON on our stdout.
+    const int devNull = ::open ("/dev/null", O_WRONLY);
+    if (devNull >= 0)
+    {
+        ::dup2 (devNull, STDOUT_FILENO);
+        ::close (devNull);
+    }
+
+    std::string request;
+    for (unsigned served = 0; served < kIsolatedWorkerRecycleAfter; ++served)
+    {
+        if (receiveFrame (fd, request, std::chrono::steady_clock::time_point::max ()) != 1)
+            break;
+
+        auto info = scanPluginFromFactory (request);
+        classifyPluginFailure (info);
+        if (sendFrame (fd, serializePluginInfo (info)) != 1)
+            break;
+    }
+    ::_exit (0);
+}
+
+//------------------------------------------------------------------------
+// Forks isolated workers on behalf of every IsolatedWorkerPool. The server is itself forked
+// once, by the first pool, which scanPlugins builds before it starts any thread; it stays
+// single-threaded from then on. Workers that replace timed-out, crashed or recycled ones are
+// needed while scan (and --serve) threads run, and forking those from the scanner could hand
+// a child a lock that some other thread held at the fork. The server also owns the workers'
+// pids, so a pid is only ever killed or reaped by the process that forked it.
+class WorkerForkServer
+{
+public:
+    static WorkerForkServer& instance ()
+    {
+        static auto* server = new WorkerForkServer; // never destroyed; workers may outlive main
+        return *server;
+    }
+
+    // Forks a worker; returns its pid and our end of its socket in fd, or -1.
+    pid_t spawn (int& fd)
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+        fd = -1;
+        int32_t pid = -1;
+        if (!request ({kSpawn, 0}, pid, &fd) || pid <= 0)
+        {
+            if (fd >= 0)
+                ::close (fd);
+            fd = -1;
+            return -1;
+        }
+        return static_cast<pid_t> (pid);
+    }
+
+    // Kills (if asked) and reaps a worker this server forked; returns its wait status.
+    int reap (pid_t pid, bool kill)
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+        int32_t status = 0;
+        request ({kill ? kKill : kReap, static_cast<int32_t> (pid)}, status, nullptr);
+        return status;
+    }
+
+private:
+    enum : int32_t
+    {
+        kSpawn = 1,
+        kReap,
+        kKill
+    };
+
+    struct Request
+    {
+        int32_t op;
+        int32_t pid;
+    };
+
+    WorkerForkServer ()
+    {
+        int fds[2];
+        if (::socketpair (AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0)
+            return;
+        const pid_t pid = ::fork ();
+        if (pid == 0)
+        {
+            ::close (fds[0]);
+            run (fds[1]);
+        }
+        ::close (fds[1]);
+        if (pid < 0)
+        {
+            ::close (fds[0]);
+            return;
+        }
+        control = fds[0];
+    }
+
+    // One request, one reply of a single int32_t; a spawn reply carries the socket as
+    // SCM_RIGHTS. Caller holds mutex.
+    bool request (Request req, int32_t& reply, int* receivedFd)
+    {
+        if (control < 0 ||
+            transferAll (control, reinterpret_cast<char*> (&req), sizeof (req), true,
+                         std::chrono::steady_clock::time_point::max ()) != 1)
+            return false;
+        return receiveWithFd (control, reply, receivedFd);
+    }
+
+    static bool sendWithFd (int socket, int32_t value, int fd)
+    {
+        iovec iov {&value, sizeof (value)};
+        msghdr msg {};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        alignas (cmsghdr) char control[CMSG_SPACE (sizeof (int))] {};
+        if (fd >= 0)
+        {
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof (control);
+            auto* cmsg = CMSG_FIRSTHDR (&msg);
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type = SCM_RIGHTS;
+            cmsg->cmsg_len = CMSG_LEN (sizeof (int));
+            std::memcpy (CMSG_DATA (cmsg), &fd, sizeof (int));
+        }
+        ssize_t n;
+        while ((n = ::sendmsg (socket, &msg, MSG_NOSIGNAL)) < 0 && errno == EINTR)
+            ;
+        return n == sizeof (value);
+    }
+
+    static bool receiveWithFd (int socket, int32_t& value, int* fd)
+    {
+        iovec iov {&value, sizeof (value)};
+        msghdr msg {};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        alignas (cmsghdr) char control[CMSG_SPACE (sizeof (int))] {};
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof (control);
+        ssize_t n;
+        while ((n = ::recvmsg (socket, &msg, MSG_CMSG_CLOEXEC)) < 0 && errno == EINTR)
+            ;
+        for (auto* cmsg = CMSG_FIRSTHDR (&msg); cmsg; cmsg = CMSG_NXTHDR (&msg, cmsg))
+        {
+            if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS)
+                continue;
+            int received = -1;
+            std::memcpy (&received, CMSG_DATA (cmsg), sizeof (int));
+            if (fd)
+                *fd = received;
+            else
+                ::close (received);
+        }
+        return n == sizeof (value);
+    }
+
+    // Whatever the scanner had open when the server was forked (journal, output, cache,
+    // sockets) is none of a worker's business.
+    static void closeInheritedDescriptors (int keep)
+    {
+        std::vector<int> open;
+        if (DIR* dir = ::opendir ("/proc/self/fd"))
+        {
+            while (const dirent* entry = ::readdir (dir))
+            {
+                const int fd = std::atoi (entry->d_name);
+                if (fd > STDERR_FILENO && fd != keep && fd != ::dirfd (dir))
+                    open.push_back (fd);
+            }
+            ::closedir (dir);
+        }
+        for (int fd : open)
+            ::close (fd);
+    }
+
+    [[noreturn]] static void run (int control)
+    {
+        closeInheritedDescriptors (control);
+        std::set<pid_t> workers;
+        Request req {};
+        while (transferAll (control, reinterpret_cast<char*> (&req), sizeof (req), false,
+                            std::chrono::steady_clock::time_point::max ()) == 1)
+        {
+            if (req.op == kSpawn)
+            {
+                int fds[2];
+                pid_t pid = -1;
+                if (::socketpair (AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0)
+                    fds[0] = fds[1] = -1;
+                else if ((pid = ::fork ()) == 0)
+                {
+                    ::close (control);
+                    ::close (fds[0]);
+                    runIsolatedWorkerChild (fds[1]);
+                }
+                if (fds[1] >= 0)
+                    ::close (fds[1]);
+                if (pid > 0)
+                    workers.insert (pid);
+                const bool sent = sendWithFd (control, pid, pid > 0 ? fds[0] : -1);
+                if (fds[0] >= 0)
+                    ::close (fds[0]);
+                if (!sent)
+                    break;
+            }
+            else
+            {
+                int status = 0;
+                const pid_t pid = req.pid;
+                if (workers.erase (pid) > 0)
+                {
+                    if (req.op == kKill)
+                        ::kill (pid, SIGKILL);
+                    while (::waitpid (pid, &status, 0) < 0 && errno == EINTR)
+                        ;
+                }
+                if (!sendWithFd (control, status, -1))
+                    break;
+            }
+        }
+        // The scanner is gone. Idle workers exit on their own once their socket closes; hung
+        // ones would not.
+        for (pid_t pid : workers)
+            ::kill (pid, SIGKILL);
+        ::_exit (0);
+    }
+
+    int control {-1};
+    std::mutex mutex;
+};
+
+class IsolatedWorkerPool
+{
+public:
+    explicit IsolatedWorkerPool (unsigned size) : workers ((std::max) (1u, size))
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+        for (auto& w : workers)
+            spawn (w);
+    }
+
+    ~IsolatedWorkerPool ()
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+        for (auto& w : workers)
+            retire (w, false);
+    }
+
+    PluginInfo scan (const std::string& pluginPath, unsigned timeoutSec,
+                     ScanTrace::Track* trace = nullptr)
+    {
+        // Includes re-forking a worker that an earlier timeout or crash retired.
+        const auto acquireStarted = std::chrono::steady_clock::now ();
+        auto& w = acquire ();
+        if (trace)
+            trace->span ("acquire worker", acquireStarted, std::chrono::steady_clock::now ());
+
+        PluginInfo info;
+        info.path = pluginPath;
+
+        if (w.pid <= 0)
+        {
+            info.errorMessage = "Failed to start isolated plugin scan worker";
+            release (w);
+            return info;
+        }
+
+        const auto deadline = timeoutSec > 0 ? std::chrono::steady_clock::now () +
+                                                   std::chrono::seconds (timeoutSec)
+                                             : std::chrono::steady_clock::time_point::max ();
+        std::string reply;
+        int rc = sendFrame (w.fd, pluginPath);
+        if (rc == 1)
+            rc = receiveFrame (w.fd, reply, deadline);
+
+        if (rc == 1 && deserializePluginInfo (reply, info))
+        {
+            if (++w.served >= kIsolatedWorkerRecycleAfter)
+                retire (w, false);
+        }
+        else if (rc == -2)
+        {
+            const auto killStarted = std::chrono::steady_clock::now ();
+            retire (w, true);
+            if (trace)
+                trace->span ("kill", killStarted, std::chrono::steady_clock::now ());
+            info.errorMessage = "Timed out loading plugin (hung initializer or modal UI)";
+            info.loadTimedOut = true;
+            classifyPluginFailure (info);
+        }
+        else
+        {
+            const auto reapStarted = std::chrono::steady_clock::now ();
+            const int status = retire (w, false);
+            if (trace)
+                trace->span ("reap crashed worker", reapStarted, std::chrono::steady_clock::now ());
+            std::ostringstream msg;
+            if (WIFSIGNALED (status))
+                msg << "Isolated worker crashed (signal " << WTERMSIG (status) << ": "
+                    << strsignal (WTERMSIG (status)) << "; plugin may have crashed on load)";
+            else
+                msg << "Isolated worker exited without result (exit code "
+                    << (WIFEXITED (status) ? WEXITSTATUS (status) : -1)
+                    << "; plugin may have crashed on load)";
+            info.errorMessage = msg.str ();
+            classifyPluginFailure (info);
+        }
+
+        release (w);
+        return info;
+    }
+
+private:
+    struct Worker
+    {
+        pid_t pid {-1};
+        int fd {-1};
+        unsigned served {0};
+        bool busy {false};
+    };
+
+    Worker& acquire ()
+    {
+        std::unique_lock<std::mutex> lock (mutex);
+        Worker* idle = nullptr;
+        available.wait (lock, [&] () {
+            for (auto& w : workers)
+            {
+                if (!w.busy)
+                {
+                    idle = &w;
+                    return true;
+                }
+            }
+            return false;
+        });
+        idle->busy = true;
+        if (idle->pid <= 0)
+            spawn (*idle);
+        return *idle;
+    }
+
+    void release (Worker& w)
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+        w.busy = false;
+        available.notify_one ();
+    }
+
+    void spawn (Worker& w)
+    {
+        w.pid = WorkerForkServer::instance ().spawn (w.fd);
+        w.served = 0;
+    }
+
+    // Closing our end makes an idle child exit on its own; a hung one needs SIGKILL.
+    int retire (Worker& w, bool kill)
+    {
+        int status = 0;
+        if (w.pid > 0)
+        {
+            ::close (w.fd);
+            status = WorkerForkServer::instance ().reap (w.pid, kill);
+        }
+        w.pid = -1;
+        w.fd = -1;
+        w.served = 0;
+        return status;
+    }
+
+    std::vector<Worker> workers;
+    std::mutex mutex;
+    std::condition_variable available;
+};
+#endif
+
+//------------------------------------------------------------------------
+// Bounds how many module loads one scan worker may have in flight. A slot is held by the
+// thread that actually calls Module::create, not by the worker waiting on it, so a load that
+// outlives its timeout keeps its DLL/.so mapped and keeps counting against the worker.
+class InFlightLoadLimiter
+{
+public:
+    using Slot = std::shared_ptr<void>;
+
+    // Notified whenever a slot of a limiter sharing it is released.
+    struct ReleaseSignal
+    {
+        std::mutex mutex;
+        std::condition_variable released;
+    };
+
+    explicit InFlightLoadLimiter (unsigned maxInFlight,
+                                  std::shared_ptr<ReleaseSignal> signal = {})
+    : state (std::make_shared<State> ((std::max) (1u, maxInFlight), std::move (signal)))
+    {
+    }
+
+    // A worker runs one load at a time and its loader releases the slot before reporting back,
+    // so the only slots still held here belong to hung loads. Waiting for them would stall the
+    // worker for good; return an empty slot instead.
+    Slot tryAcquire ()
+    {
+        std::lock_guard<std::mutex> lock (state->mutex);
+        if (state->inFlight >= state->maxInFlight)
+            return {};
+        ++state->inFlight;
+        // Abandoned loader threads may release after the limiter itself is gone; keep the
+        // state alive through the deleter.
+        auto keepAlive = state;
+        return Slot (state.get (), [keepAlive] (void*) {
+            {
+                std::lock_guard<std::mutex> guard (keepAlive->mutex);
+                --keepAlive->inFlight;
+            }
+            if (auto& signal = keepAlive->signal)
+            {
+                // Under the mutex, so a waiter cannot miss it between full () and its wait.
+                std::lock_guard<std::mutex> guard (signal->mutex);
+                signal->released.notify_all ();
+            }
+        });
+    }
+
+    unsigned inFlight () const
+    {
+        std::lock_guard<std::mutex> lock (state->mutex);
+        return state->inFlight;
+    }
+
+    bool full () const
+    {
+        std::lock_guard<std::mutex> lock (state->mutex);
+        return state->inFlight >= state->maxInFlight;
+    }
+
+private:
+    struct State
+    {
+        State (unsigned max, std::shared_ptr<ReleaseSignal> signal)
+        : maxInFlight (max), signal (std::move (signal))
+        {
+        }
+        const unsigned maxInFlight;
+        const std::shared_ptr<ReleaseSignal> signal;
+        unsigned inFlight {0};
+        mutable std::mutex mutex;
+    };
+    std::shared_ptr<State> state;
+};
+
+//------------------------------------------------------------------------
+// Keeps scan workers whose every load slot is held by a hung load from pulling work: such a
+// worker could only mark plugins "skipped", and would drain the queue in microseconds while
+// healthy workers sit idle. It parks until one of its slots frees. Once no worker is left
+// running, the parked ones give the hung loads one more load timeout; after that the gate
+// opens for good and the remaining loads are skipped, since no worker can load at all.
+class LoadSlotGate
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    LoadSlotGate (unsigned workers, unsigned patienceSec)
+    : signal (std::make_shared<InFlightLoadLimiter::ReleaseSignal> ())
+    , patience (std::chrono::seconds (patienceSec))
+    , running (workers)
+    {
+    }
+
+    const std::shared_ptr<InFlightLoadLimiter::ReleaseSignal>& releaseSignal () const
+    {
+        return signal;
+    }
+
+    // Called before a worker pulls its next plugin. loadsRefused: the abandon budget is spent,
+    // so loads are skipped whatever this worker holds and waiting would gain nothing.
+    void admit (const InFlightLoadLimiter& limiter, bool loadsRefused)
+    {
+        std::unique_lock<std::mutex> lock (signal->mutex);
+        if (open || loadsRefused || !limiter.full ())
+            return;
+
+        if (--running == 0)
+            stalledSince = Clock::now ();
+        while (!open && !closed && limiter.full ())
+        {
+            if (running > 0)
+            {
+                signal->released.wait (lock);
+                continue;
+            }
+            if (signal->released.wait_until (lock, stalledSince + patience) ==
+                    std::cv_status::timeout &&
+                running == 0 && limiter.full ())
+            {
+                open = true;
+                signal->released.notify_all ();
+            }
+        }
+        ++running;
+    }
+
+    // A worker found the schedule empty and is leaving; parked workers need not wait for it.
+    void leave ()
+    {
+        {
+            std::lock_guard<std::mutex> lock (signal->mutex);
+            closed = true;
+            --running;
+        }
+        signal->released.notify_all ();
+    }
+
+private:
+    const std::shared_ptr<InFlightLoadLimiter::ReleaseSignal> signal;
+    const Clock::duration patience;
+    unsigned running;
+    Clock::time_point stalledSince;
+    bool open {false};
+    bool closed {false};
+};
+
+//------------------------------------------------------------------------
+// Persistent scan results keyed by module path. A cached result is reused while the module's
+// stamp (size + newest mtime) is unchanged; if the stamp moved, a content fingerprint decides,
+// so a touched-but-identical module still avoids a factory load.
+class ScanCache
+{
+public:
+    ScanCache (std::string file, int retryFailedHours)
+    : file (std::move (file)), retryFailedHours (retryFailedHours)
+    {
+    }
+
+    void load ()
+    {
+        std::ifstream in (file, std::ios::binary);
+        if (!in)
+            return;
+
+        std::string data ((std::istreambuf_iterator<char> (in)), std::istreambuf_iterator<char> ());
+        size_t pos = 0;
+        uint32_t magic = 0, count = 0;
+        if (!readWireU32 (data, pos, magic) || magic != kMagic || !readWireU32 (data, pos, count))
+            return;
+
+        for (uint32_t n = 0; n < count; ++n)
+        {
+            Entry entry;
+            std::string blob;
+            uint64_t scannedAt = 0;
+            if (!readWireU64 (data, pos, entry.stamp.size) ||
+                !readWireU64 (data, pos, entry.stamp.mtime) ||
+                !readWireU64 (data, pos, entry.fingerprint) || !readWireU64 (data, pos, scannedAt) ||
+                !readWireString (data, pos, blob) || !deserializePluginInfo (blob, entry.info))
+                break; // truncated file: keep what parsed
+            entry.scannedAt = static_cast<int64_t> (scannedAt);
+            auto key = entry.info.path;
+            entries[key] = std::move (entry);
+        }
+    }
+
+    bool save ()
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+        if (!dirty)
+            return true;
+
+        std::string data;
+        appendWireU32 (data, kMagic);
+        const auto countPos = data.size ();
+        appendWireU32 (data, 0);
+
+        uint32_t count = 0;
+        std::error_code ec;
+        for (const auto& [path, entry] : entries)
+        {
+            if (!std::filesystem::exists (path, ec))
+                continue; // module was uninstalled
+            appendWireU64 (data, entry.stamp.size);
+            appendWireU64 (data, entry.stamp.mtime);
+            appendWireU64 (data, entry.fingerprint);
+            appendWireU64 (data, static_cast<uint64_t> (entry.scannedAt));
+            appendWireString (data, serializePluginInfo (entry.info));
+            ++count;
+        }
+        std::memcpy (&data[countPos], &count, sizeof (count));
+
+        const auto tmp = file + ".tmp";
+        {
+            // A short write (disk full) only shows once the stream is flushed and closed; the
+            // old cache is kept rather than replaced by a truncated one.
+            std::ofstream out (tmp, std::ios::binary | std::ios::trunc);
+            out.write (data.data (), static_cast<std::streamsize> (data.size ()));
+            out.flush ();
+            out.close ();
+            if (out.fail ())
+            {
+                std::filesystem::remove (tmp, ec);
+                return false;
+            }
+        }
+        std::filesystem::rename (tmp, file, ec);
+        if (ec)
+            return false;
+        dirty = false;
+        return true;
+    }
+
+    // trustSkips is false under --try-license-load, where a cached heuristic skip is stale;
+    // trustModuleInfo is false when moduleinfo.json results must be replaced by a load.
+    bool lookup (const std::string& pluginPath, bool trustSkips, bool trustModuleInfo,
+                 PluginInfo& out)
+    {
+        const auto stamp = stampModule (pluginPath);
+
+        // Copied out under the lock; the fingerprint reads the module, which must not hold up
+        // the other workers' lookups (store () likewise fingerprints before locking).
+        Entry entry;
+        {
+            std::lock_guard<std::mutex> lock (mutex);
+            const auto it = entries.find (pluginPath);
+            if (it == entries.end ())
+                return miss ();
+            entry = it->second;
+        }
+
+        if (!(entry.stamp == stamp))
+        {
+            if (fingerprintModule (pluginPath) != entry.fingerprint)
+                return miss ();
+
+            std::lock_guard<std::mutex> lock (mutex);
+            const auto it = entries.find (pluginPath);
+            if (it != entries.end () && it->second.fingerprint == entry.fingerprint)
+            {
+                it->second.stamp = stamp;
+                dirty = true;
+            }
+        }
+
+        if (!trustModuleInfo && entry.info.scanSource == "moduleinfo")
+            return miss ();
+        if (!entry.info.isValid)
+        {
+            if (!trustSkips && entry.info.scanSource == "skipped")
+                return miss ();
+            const auto ageSec = nowSec () - entry.scannedAt;
+            if (retryFailedHours == 0 ||
+                (retryFailedHours > 0 && ageSec >= int64_t (retryFailedHours) * 3600))
+                return miss ();
+        }
+
+        out = std::move (entry.info);
+        ++hitCount;
+        return true;
+    }
+
+    void store (const PluginInfo& info)
+    {
+        // Scheduler refusals say nothing about the module itself.
+        if (info.scanSource == "skipped" && info.errorMessage.find ("hung loads") != std::string::npos)
+            return;
+
+        Entry entry;
+        entry.stamp = stampModule (info.path);
+        entry.fingerprint = fingerprintModule (info.path);
+        entry.scannedAt = nowSec ();
+        entry.info = info;
+
+        std::lock_guard<std::mutex> lock (mutex);
+        entries[info.path] = std::move (entry);
+        dirty = true;
+    }
+
+    size_t hits () const { return hitCount; }
+    size_t misses () const { return missCount; }
+
+    // How the last load of a module went, whether or not the module changed since. Only the
+    // scan order depends on it.
+    struct LoadHistory
+    {
+        bool valid {false};
+        bool hung {false}; // timed out
+        uint32_t totalUs {0};
+    };
+
+    bool history (const std::string& pluginPath, LoadHistory& out)
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+        const auto it = entries.find (pluginPath);
+        if (it == entries.end ())
+            return false;
+        const auto& info = it->second.info;
+        out.valid = info.isValid;
+        out.hung = info.loadTimedOut;
+        out.totalUs = info.timings.totalUs;
+        return true;
+    }
+
+private:
+    static constexpr uint32_t kMagic = 0x35435356; // "VSC5"; bump when PluginInfo's encoding changes
+
+    struct Stamp
+    {
+        uint64_t size {0};
+        uint64_t mtime {0};
+        bool operator== (const Stamp& other) const
+        {
+            return size == other.size && mtime == other.mtime;
+        }
+    };
+
+    struct Entry
+    {
+        Stamp stamp;
+        uint64_t fingerprint {0};
+        int64_t scannedAt {0};
+        PluginInfo info;
+    };
+
+    bool miss ()
+    {
+        ++missCount;
+        return false;
+    }
+
+    static int64_t nowSec ()
+    {
+        return std::chrono::duration_cast<std::chrono::seconds> (
+                   std::chrono::system_clock::now ().time_since_epoch ())
+            .count ();
+    }
+
+    // The files that make up a module: the file itself, or the binaries one level under a
+    // bundle's Contents/<arch>/ (the same files bundleUsesLicenseWrapper inspects).
+    static std::vector<std::filesystem::path> moduleFiles (const std::filesystem::path& modulePath)
+    {
+        std::vector<std::filesystem::path> files;
+        std::error_code ec;
+        if (!std::filesystem::is_directory (modulePath, ec))
+        {
+            files.push_back (modulePath);
+            return files;
+        }
+
+        for (const auto& archEntry :
+             std::filesystem::directory_iterator (modulePath / "Contents", ec))
+        {
+            if (ec || !archEntry.is_directory (ec))
+                continue;
+            for (const auto& fileEntry : std::filesystem::directory_iterator (archEntry.path (), ec))
+            {
+                if (!ec && fileEntry.is_regular_file (ec))
+                    files.push_back (fileEntry.path ());
+            }
+        }
+        std::sort (files.begin (), files.end ());
+        return files;
+    }
+
+    static Stamp stampModule (const std::string& pluginPath)
+    {
+        Stamp stamp;
+        std::error_code ec;
+        for (const auto& f : moduleFiles (pluginPath))
+        {
+            const auto size = std::filesystem::file_size (f, ec);
+            if (!ec)
+                stamp.size += size;
+            const auto mtime = std::filesystem::last_write_time (f, ec);
+            if (!ec)
+                stamp.mtime = (std::max) (stamp.mtime, static_cast<uint64_t> (
+                                                           mtime.time_since_epoch ().count ()));
+        }
+        return stamp;
+    }
+
+    // FNV-1a over each file's name, size and first/last 64 KB. Cheap enough for every miss,
+    // and catches rebuilt binaries that happen to keep their size.
+    static uint64_t fingerprintModule (const std::string& pluginPath)
+    {
+        constexpr size_t kSample = 64 * 1024;
+        uint64_t hash = 1469598103934665603ull;
+        auto mix = [&hash] (const char* data, size_t size) {
+            for (size_t i = 0; i < size; ++i)
+            {
+                hash ^= static_cast<unsigned char> (data[i]);
+                hash *= 1099511628211ull;
+            }
+        };
+
+        std::vector<char> buffer (kSample);
+        std::error_code ec;
+        for (const auto& f : moduleFiles (pluginPath))
+        {
+            const auto name = f.filename ().string ();
+            mix (name.data (), name.size ());
+            const uint64_t size = std::filesystem::file_size (f, ec);
+            if (ec)
+                continue;
+            mix (reinterpret_cast<const char*> (&size), sizeof (size));
+
+            std::ifstream in (f, std::ios::binary);
+            in.read (buffer.data (), static_cast<std::streamsize> (kSample));
+            mix (buffer.data (), static_cast<size_t> (in.gcount ()));
+            if (size > kSample)
+            {
+                const auto tail = (std::min) (size - kSample, static_cast<uint64_t> (kSample));
+                in.clear ();
+                in.seekg (static_cast<std::streamoff> (size - tail));
+                in.read (buffer.data (), static_cast<std::streamsize> (tail));
+                mix (buffer.data (), static_cast<size_t> (in.gcount ()));
+            }
+        }
+        return hash;
+    }
+
+    const std::string file;
+    const int retryFailedHours;
+    std::unordered_map<std::string, Entry> entries;
+    std::mutex mutex;
+    bool dirty {false};
+    std::atomic<size_t> hitCount {0};
+    std::atomic<size_t> missCount {0};
+};
+
+// Per-worker state threaded from scanPlugins down to the load engines.
+struct LoadContext
+{
+    InFlightLoadLimiter* limiter {nullptr};
+    ScanCache* cache {nullptr};
+    ScanTrace::Track* trace {nullptr}; // this worker's track, when --trace is on
+#if SMTG_OS_LINUX
+    IsolatedWorkerPool* isolatedWorkers {nullptr};
+#endif
+};
+
+//------------------------------------------------------------------------
+// Loads that missed their deadline. Their threads are detached and keep running until
+// Module::create returns (if ever); the registry is process-wide because they outlive scans.
+class AbandonedLoadRegistry
+{
+public:
+    static AbandonedLoadRegistry& instance ()
+    {
+        static auto* registry = new AbandonedLoadRegistry; // never destroyed; loaders may outlive main
+        return *registry;
+    }
+
+    size_t add (const std::string& pluginPath, unsigned timeoutSec)
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+        AbandonedLoad load;
+        load.path = pluginPath;
+        load.timeoutSec = timeoutSec;
+        loads.push_back (std::move (load));
+        abandonedAt.push_back (std::chrono::steady_clock::now ());
+        ++running;
+        return loads.size () - 1;
+    }
+
+    void finished (size_t index)
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+        auto& load = loads[index];
+        load.finished = true;
+        load.finishedLateMs = std::chrono::duration_cast<std::chrono::milliseconds> (
+                                  std::chrono::steady_clock::now () - abandonedAt[index])
+                                  .count ();
+        --running;
+    }
+
+    size_t stillRunning () const
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+        return running;
+    }
+
+    std::vector<AbandonedLoad> snapshot () const
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+        return loads;
+    }
+
+private:
+    mutable std::mutex mutex;
+    std::vector<AbandonedLoad> loads;
+    std::vector<std::chrono::steady_clock::time_point> abandonedAt;
+    size_t running {0};
+};
+
+// Shared between the waiting scan worker and the detached loader thread; whoever finishes
+// last frees it.
+struct PendingLoad
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool done {false};
+    bool abandoned {false};
+    size_t abandonedIndex {0};
+    PluginInfo result;
+};
+
+PluginInfo scanPluginFromFactoryWithTimeout (const std::string& pluginPath, unsigned timeoutSec,
+                                             const ScanOptions& options,
+                                             InFlightLoadLimiter::Slot slot = {})
+{
+    PluginInfo info;
+    info.path = pluginPath;
+    info.isValid = false;
+
+    auto& registry = AbandonedLoadRegistry::instance ();
+    if (registry.stillRunning () >= options.maxAbandonedLoads)
+    {
+        info.loadFailed = true;
+        info.scanSource = "skipped";
+        info.errorMessage = "Factory load skipped (" + std::to_string (registry.stillRunning ()) +
+                            " hung loads still running; use --isolate)";
+        return info;
+    }
+
+    auto pending = std::make_shared<PendingLoad> ();
+    try
+    {
+        std::thread ([pending, pluginPath, slot] () mutable {
+            auto result = scanPluginFromFactory (pluginPath);
+            slot.reset ();
+            std::lock_guard<std::mutex> lock (pending->mutex);
+            pending->result = std::move (result);
+            pending->done = true;
+            if (pending->abandoned)
+                AbandonedLoadRegistry::instance ().finished (pending->abandonedIndex);
+            pending->cv.notify_all ();
+        }).detach ();
+    }
+    catch (const std::system_error& e)
+    {
+        info.errorMessage = std::string ("Could not start loader thread: ") + e.what ();
+        return info;
+    }
+
+    std::unique_lock<std::mutex> lock (pending->mutex);
+    if (!pending->cv.wait_for (lock, std::chrono::seconds (timeoutSec),
+                               [&] () { return pending->done; }))
+    {
+        pending->abandoned = true;
+        pending->abandonedIndex = registry.add (pluginPath, timeoutSec);
+        info.errorMessage = "Timed out loading plugin (loader thread abandoned)";
+        return info;
+    }
+
+    return std::move (pending->result);
+}
+
+// Module::create and classInfos () ran on a loader thread or in a worker process, so their
+// spans are placed from the returned durations: both phases end just before the result is
+// handed back.
+void traceLoad (ScanTrace::Track& trace, const PluginInfo& info, bool isolated,
+                std::chrono::steady_clock::time_point loadStarted)
+{
+    const auto loadEnded = std::chrono::steady_clock::now ();
+    const char* name = info.loadTimedOut ? "timeout" : isolated ? "isolated load" : "load";
+    trace.span (name, loadStarted, loadEnded);
+
+    const auto classInfoStarted = loadEnded - std::chrono::microseconds (info.timings.classInfoUs);
+    const auto moduleLoadStarted =
+        classInfoStarted - std::chrono::microseconds (info.timings.moduleLoadUs);
+    if (info.timings.moduleLoadUs > 0)
+        trace.span ("Module::create", (std::max) (moduleLoadStarted, loadStarted),
+                    classInfoStarted);
+    if (info.timings.classInfoUs > 0)
+        trace.span ("classInfos", (std::max) (classInfoStarted, loadStarted), loadEnded);
+}
+
+// True if both list the same class IDs, in any order.
+bool sameClassIDs (const PluginInfo& a, const PluginInfo& b)
+{
+    if (a.classes.size () != b.classes.size ())
+        return false;
+    std::vector<std::string> idsA, idsB;
+    idsA.reserve (a.classes.size ());
+    idsB.reserve (b.classes.size ());
+    for (const auto& entry : a.classes)
+        idsA.push_back (entry.cid);
+    for (const auto& entry : b.classes)
+        idsB.push_back (entry.cid);
+    std::sort (idsA.begin (), idsA.end ());
+    std::sort (idsB.begin (), idsB.end ());
+    return idsA == idsB;
+}
+
+PluginInfo loadPluginViaFactory (const std::string& pluginPath, const ScanOptions& options,
+                                 const LoadContext& context = {})
+{
+    auto* limiter = context.limiter;
+
+    PluginInfo info;
+    info.path = pluginPath;
+
+    auto* trace = context.trace;
+
+    // A bundle's moduleinfo.json describes it without running any of its code, so it comes
+    // before the license and vendor heuristics, which only guard loads. Under
+    // --verify-moduleinfo the module is loaded anyway and the file is checked against it.
+    const auto analyzeStarted = std::chrono::steady_clock::now ();
+    PluginInfo declared;
+    const bool hasModuleInfo = options.useModuleInfo && readModuleInfo (pluginPath, declared);
+    if (trace && hasModuleInfo)
+        trace->span ("moduleinfo", analyzeStarted, std::chrono::steady_clock::now ());
+    if (hasModuleInfo && !options.verifyModuleInfo)
+    {
+        declared.path = pluginPath;
+        declared.timings.analyzeUs = elapsedMicros (analyzeStarted);
+        return declared;
+    }
+
+    const auto heuristicsStarted = std::chrono::steady_clock::now ();
+    const auto analysis = analyzeModule (pluginPath);
+    const uint32_t analyzeUs = elapsedMicros (analyzeStarted);
+    info.analysis = analysis;
+    info.timings.analyzeUs = analyzeUs;
+    if (trace)
+        trace->span ("analyze", heuristicsStarted, std::chrono::steady_clock::now ());
+
+    if (options.checkModuleBinary && !analysis.binaryProblem.empty ())
+    {
+        info.isValid = false;
+        info.loadFailed = true;
+        info.errorMessage = "Cannot load here: " + analysis.binaryProblem;
+        return info;
+    }
+
+    if (options.fastLicenseSkip && analysis.needsLicense ())
+    {
+        info.isValid = false;
+        info.missingLicense = true;
+        info.scanSource = "skipped";
+        info.errorMessage = "License protection detected; DLL load skipped";
+        return info;
+    }
+
+    if (options.fastLicenseSkip && analysis.unsafeFactoryLoad ())
+    {
+        info.isValid = false;
+        info.loadFailed = true;
+        info.scanSource = "skipped";
+        info.errorMessage =
+            "Factory load skipped (plugin alerts or blocks headless scan, e.g. iZotope)";
+        return info;
+    }
+
+    unsigned timeoutSec = options.factoryLoadTimeoutSec;
+    if (analysis.needsLicense ())
+        timeoutSec = (std::min) (timeoutSec, options.protectedPluginTimeoutSec);
+
+    // Whatever the worker round trip costs beyond the child's own load is worker overhead.
+    const auto loadStarted = std::chrono::steady_clock::now ();
+    const auto chargeWorker = [&info, loadStarted] () {
+        const uint32_t roundTrip = elapsedMicros (loadStarted);
+        const uint32_t inChild = info.timings.moduleLoadUs + info.timings.classInfoUs;
+        info.timings.workerUs = roundTrip > inChild ? roundTrip - inChild : 0;
+    };
+
+    bool isolated = false;
+
+#if SMTG_OS_WINDOWS
+    if (options.isolateFactoryLoad)
+    {
+        info = scanPluginFromFactoryIsolated (pluginPath, timeoutSec, options.workerExecutable,
+                                              trace);
+        chargeWorker ();
+        isolated = true;
+    }
+    else
+#elif SMTG_OS_LINUX
+    if (options.isolateFactoryLoad && context.isolatedWorkers)
+    {
+        info = context.isolatedWorkers->scan (pluginPath, timeoutSec, trace);
+        chargeWorker ();
+        isolated = true;
+    }
+    else
+#endif
+    {
+        InFlightLoadLimiter::Slot slot;
+        if (limiter)
+        {
+            slot = limiter->tryAcquire ();
+            if (!slot)
+            {
+                info.loadFailed = true;
+                info.scanSource = "skipped";
+                info.errorMessage = "Factory load skipped (" +
+                                    std::to_string (limiter->inFlight ()) +
+                                    " hung loads still hold this worker)";
+                return info;
+            }
+        }
+
+        if (timeoutSec > 0)
+            info = scanPluginFromFactoryWithTimeout (pluginPath, timeoutSec, options,
+                                                     std::move (slot));
+        else
+            info = scanPluginFromFactory (pluginPath);
+    }
+
+    info.analysis = analysis;
+    info.timings.analyzeUs = analyzeUs;
+    classifyPluginFailure (info);
+    if (trace)
+        traceLoad (*trace, info, isolated, loadStarted);
+    if (hasModuleInfo && info.isValid && !options.quiet && !sameClassIDs (declared, info))
+        logLine ("moduleinfo.json does not match the factory: " + pluginPath);
+    return info;
+}
+
+const char* traceOutcome (const PluginInfo& info)
+{
+    if (info.isValid)
+        return "valid";
+    if (info.missingLicense)
+        return "missingLicense";
+    if (info.loadTimedOut)
+        return "timedOut";
+    return info.scanSource == "skipped" ? "skipped" : "failed";
+}
+
+PluginInfo scanOnePlugin (const std::string& pluginPath, const ScanOptions& options,
+                          const LoadContext& context)
+{
+    if (options.skipFactoryLoad)
+    {
+        PluginInfo info;
+        info.path = pluginPath;
+        // Reading moduleinfo.json runs no plugin code, so it is allowed here too.
+        if (options.useModuleInfo && readModuleInfo (pluginPath, info))
+            return info;
+        info.loadFailed = true;
+        info.errorMessage = "Factory load skipped (--no-factory)";
+        return info;
+    }
+
+    const auto started = std::chrono::steady_clock::now ();
+    PluginInfo info;
+    const bool trustModuleInfo = options.useModuleInfo && !options.verifyModuleInfo;
+    if (context.cache &&
+        context.cache->lookup (pluginPath, options.fastLicenseSkip, trustModuleInfo, info))
+    {
+        // Nothing was loaded this time; the stored timings belong to the run that did.
+        info.timings = ScanTimings ();
+        info.timings.cacheUs = info.timings.totalUs = elapsedMicros (started);
+        if (context.trace)
+            context.trace->span ("scan", started, std::chrono::steady_clock::now (), pluginPath,
+                                 "cached");
+        return info;
+    }
+    const uint32_t cacheUs = context.cache ? elapsedMicros (started) : 0;
+    if (context.trace && context.cache)
+        context.trace->span ("cache", started, started + std::chrono::microseconds (cacheUs));
+
+    info = loadPluginViaFactory (pluginPath, options, context);
+    info.timings.cacheUs = cacheUs;
+    info.timings.totalUs = elapsedMicros (started);
+    if (context.trace)
+        context.trace->span ("scan", started, std::chrono::steady_clock::now (), pluginPath,
+                             traceOutcome (info));
+    if (context.cache)
+        context.cache->store (info);
+    return info;
+}
+
+unsigned resolveJobCount (const ScanOptions& options, size_t pluginCount)
+{
+    unsigned jobs = options.jobs;
+    if (jobs == 0)
+        jobs = (std::max) (1u, std::thread::hardware_concurrency ());
+    if (options.skipFactoryLoad)
+        jobs = 1;
+    return static_cast<unsigned> ((std::min) (static_cast<size_t> (jobs), pluginCount));
+}
+
+//------------------------------------------------------------------------
+// Hands out scan work cheapest-first, from what the cache remembers of each module: modules
+// that loaded last time (fastest first), then modules never seen, then ones that failed.
+// Modules whose last load timed out go to a slow lane that at most slowLaneJobs workers
+// drain at once. With several workers the lane starts right away, so its timeouts overlap
+// the fast work instead of trailing it. Without history the input order is kept. Results
+// carry their input index either way, so collected output does not depend on this order.
+// Paths marked done (resumed from a journal) are never handed out, and after the deadline
+// nothing more is.
+class ScanSchedule
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Item
+    {
+        size_t index {0};
+        bool slow {false};
+    };
+
+    ScanSchedule (const std::vector<std::string>& paths, const std::vector<bool>& done,
+                  ScanCache* history, unsigned jobs, unsigned slowLaneJobs)
+    : jobs (jobs)
+    {
+        // A lane as wide as the pool would starve the fast list.
+        slowLimit = (std::max) (1u, (std::min) (slowLaneJobs, jobs > 1 ? jobs - 1 : 1u));
+
+        struct Ranked
+        {
+            int tier;
+            uint32_t costUs;
+            size_t index;
+        };
+        std::vector<Ranked> ranked;
+        ranked.reserve (paths.size ());
+        for (size_t i = 0; i < paths.size (); ++i)
+        {
+            ScanCache::LoadHistory last;
+            if (done[i])
+                continue;
+            if (!history || !history->history (paths[i], last))
+                ranked.push_back ({1, 0, i});
+            else if (last.hung && slowLaneJobs > 0)
+                slow.push_back (i);
+            else
+                ranked.push_back ({last.hung ? 3 : last.valid ? 0 : 2, last.totalUs, i});
+        }
+        std::sort (ranked.begin (), ranked.end (), [] (const Ranked& a, const Ranked& b) {
+            if (a.tier != b.tier)
+                return a.tier < b.tier;
+            if (a.costUs != b.costUs)
+                return a.costUs < b.costUs;
+            return a.index < b.index;
+        });
+        fast.reserve (ranked.size ());
+        for (const auto& r : ranked)
+            fast.push_back (r.index);
+    }
+
+    void setDeadline (Clock::time_point at)
+    {
+        deadline = at;
+        hasDeadline = true;
+    }
+
+    bool next (Item& item)
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+        if (hasDeadline && Clock::now () >= deadline)
+        {
+            deadlinePassed = true;
+            return false;
+        }
+        const bool slowOpen = slowNext < slow.size () && slowActive < slowLimit;
+        if (slowOpen && (jobs > 1 || fastNext >= fast.size ()))
+        {
+            ++slowActive;
+            item = {slow[slowNext++], true};
+            return true;
+        }
+        if (fastNext < fast.size ())
+        {
+            item = {fast[fastNext++], false};
+            return true;
+        }
+        return false;
+    }
+
+    void done (const Item& item)
+    {
+        if (!item.slow)
+            return;
+        std::lock_guard<std::mutex> lock (mutex);
+        --slowActive;
+    }
+
+    // Paths never handed out because the deadline passed first.
+    size_t cutOff ()
+    {
+        std::lock_guard<std::mutex> lock (mutex);
+        return deadlinePassed ? (fast.size () - fastNext) + (slow.size () - slowNext) : 0;
+    }
+
+private:
+    const unsigned jobs;
+    unsigned slowLimit {1};
+    std::vector<size_t> fast;
+    std::vector<size_t> slow;
+    std::mutex mutex;
+    size_t fastNext {0};
+    size_t slowNext {0};
+    unsigned slowActive {0};
+    Clock::time_point deadline;
+    bool hasDeadline {false};
+    bool deadlinePassed {false};
+};
+
+// A journal's plugin records by path. Each line is parsed on its own, so the record a killed
+// run was writing costs only that line; later records for a path win.
+std::unordered_map<std::string, PluginInfo> readJournal (const std::string& journalFile)
+{
+    std::unordered_map<std::string, PluginInfo> records;
+    std::ifstream in (journalFile, std::ios::binary);
+    std::string line;
+    while (std::getline (in, line))
+    {
+        for (auto& info : parseJSONCatalog (line.data (), line.size ()))
+        {
+            if (!info.path.empty ())
+                records[info.path] = std::move (info);
+        }
+    }
+    return records;
+}
+
+// A killed run can leave a partial last line; appending straight after it would fuse the
+// next record to it.
+bool endsWithNewline (const std::string& file)
+{
+    std::ifstream in (file, std::ios::binary | std::ios::ate);
+    if (!in || in.tellg () <= 0)
+        return true;
+    in.seekg (-1, std::ios::end);
+    return in.get () == '\n';
+}
+
+//------------------------------------------------------------------------
+// What scans share beyond their options: the isolated worker pool and the loaded scan cache.
+// scanPlugins makes one per call; watchPlugins keeps one for all its rescans, so a batch of
+// one changed module neither forks a new pool nor reads the whole cache file again.
+class ScanSession
+{
+public:
+    // poolSize is the most workers any scan in this session runs at once.
+    ScanSession (const ScanOptions& options, unsigned poolSize)
+    : poolSize (poolSize), isolate (options.isolateFactoryLoad && !options.skipFactoryLoad)
+    {
+        if (!options.cacheFile.empty () && !options.skipFactoryLoad)
+        {
+            scanCache =
+                std::make_unique<ScanCache> (options.cacheFile, options.cacheRetryFailedHours);
+            scanCache->load ();
+        }
+    }
+
+    ScanCache* cache () const { return scanCache.get (); }
+
+#if SMTG_OS_LINUX
+    // Forked on first use, from the scan's own thread before its workers start. The first
+    // pool also forks the worker fork server, which forks every worker after that.
+    IsolatedWorkerPool* isolatedWorkers ()
+    {
+        if (isolate && !pool)
+            pool = std::make_unique<IsolatedWorkerPool> ((std::max) (1u, poolSize));
+        return pool.get ();
+    }
+#endif
+
+private:
+    unsigned poolSize;
+    bool isolate;
+    std::unique_ptr<ScanCache> scanCache;
+#if SMTG_OS_LINUX
+    std::unique_ptr<IsolatedWorkerPool> pool;
+#endif
+};
+
+void scanPluginsWith (const std::vector<std::string>& paths, const ScanOptions& options,
+                      const PluginResultCallback& onResult, ScanSession& session)
+{
+    const size_t total = paths.size ();
+    const unsigned jobs = resolveJobCount (options, total);
+
+#if SMTG_OS_LINUX
+    IsolatedWorkerPool* isolatedWorkers = total > 0 ? session.isolatedWorkers () : nullptr;
+#endif
+    ScanCache* cache = session.cache ();
+    const size_t hitsBefore = cache ? cache->hits () : 0;
+    const size_t missesBefore = cache ? cache->misses () : 0;
+
+    // Journal: every finished plugin is appended as an NDJSON record and flushed, so a killed
+    // scan keeps its progress. Resuming hands the journaled records back instead of scanning
+    // those paths again.
+    std::vector<bool> resumed (total, false);
+    std::ofstream journalOut;
+    std::unique_ptr<NDJSONWriter> journal;
+    if (!options.journalFile.empty ())
+    {
+        size_t resumedCount = 0;
+        bool appendJournal = false;
+        if (options.resumeJournal)
+        {
+            auto records = readJournal (options.journalFile);
+            for (size_t i = 0; i < total; ++i)
+            {
+                auto it = records.find (paths[i]);
+                if (it == records.end ())
+                    continue;
+                resumed[i] = true;
+                ++resumedCount;
+                onResult (i, std::move (it->second));
+                records.erase (it);
+            }
+            appendJournal = true;
+        }
+
+        const bool terminate = appendJournal && !endsWithNewline (options.journalFile);
+        journalOut.open (options.journalFile, appendJournal ? std::ios::app : std::ios::trunc);
+        if (journalOut.is_open ())
+        {
+            if (terminate)
+                journalOut << "\n";
+            journal = std::make_unique<NDJSONWriter> (journalOut);
+        }
+        else
+        {
+            std::cerr << "Warning: could not open scan journal: " << options.journalFile
+                      << std::endl;
+        }
+        if (options.resumeJournal && !options.quiet)
+            logLine ("Resumed " + std::to_string (resumedCount) + " plugins from journal: " +
+                     options.journalFile);
+    }
+
+    const auto finish = [&] (size_t index, PluginInfo&& info) {
+        if (journal)
+            journal->write (info);
+        onResult (index, std::move (info));
+    };
+
+    ScanSchedule schedule (paths, resumed,
+                           options.prioritizeFromHistory ? cache : nullptr, jobs,
+                           options.slowLaneJobs);
+    if (options.budgetSec > 0)
+        schedule.setDeadline (ScanSchedule::Clock::now () +
+                              std::chrono::seconds (options.budgetSec));
+
+    auto makeContext = [&] (InFlightLoadLimiter& limiter, unsigned worker) {
+        LoadContext context;
+        context.limiter = &limiter;
+        context.cache = cache;
+        if (options.trace)
+            context.trace = &options.trace->addTrack ("scan worker " + std::to_string (worker));
+#if SMTG_OS_LINUX
+        context.isolatedWorkers = isolatedWorkers;
+#endif
+        return context;
+    };
+
+    LoadSlotGate gate ((std::max) (1u, jobs), options.factoryLoadTimeoutSec);
+    const auto next = [&] (const InFlightLoadLimiter& limiter, ScanSchedule::Item& item) {
+        gate.admit (limiter, AbandonedLoadRegistry::instance ().stillRunning () >=
+                                 options.maxAbandonedLoads);
+        return schedule.next (item);
+    };
+
+    if (jobs <= 1)
+    {
+        InFlightLoadLimiter limiter (options.maxInFlightLoadsPerWorker, gate.releaseSignal ());
+        const auto context = makeContext (limiter, 1);
+        ScanSchedule::Item item;
+        while (next (limiter, item))
+        {
+            const size_t i = item.index;
+            logProgress (options, i + 1, total, paths[i], "scanning");
+            if (options.onProgress)
+                options.onProgress (i, total, paths[i], "scanning");
+            auto info = scanOnePlugin (paths[i], options, context);
+            schedule.done (item);
+            logPluginResult (options, info);
+            if (options.onProgress)
+                options.onProgress (i, total, paths[i], "done");
+            finish (i, std::move (info));
+        }
+    }
+    else
+    {
+        // Workers pull the next index from the schedule; results carry that index, so callers
+        // can restore input order regardless of completion order.
+        auto worker = [&] (unsigned workerNumber) {
+            InFlightLoadLimiter limiter (options.maxInFlightLoadsPerWorker, gate.releaseSignal ());
+            const auto context = makeContext (limiter, workerNumber);
+            ScanSchedule::Item item;
+            while (next (limiter, item))
+            {
+                const size_t i = item.index;
+                if (options.onProgress)
+                {
+                    auto lock = lockLog ();
+                    options.onProgress (i, total, paths[i], "scanning");
+                }
+                auto info = scanOnePlugin (paths[i], options, context);
+                schedule.done (item);
+
+                {
+                    auto lock = lockLog ();
+                    logPluginResult (options, i + 1, total, paths[i], info);
+                    if (options.onProgress)
+                        options.onProgress (i, total, paths[i], "done");
+                }
+                finish (i, std::move (info));
+            }
+            gate.leave ();
+        };
+
+        std::vector<std::thread> workers;
+        workers.reserve (jobs);
+        for (unsigned w = 0; w < jobs; ++w)
+            workers.emplace_back (worker, w + 1);
+        for (auto& t : workers)
+            t.join ();
+    }
+
+    if (cache)
+    {
+        // Writes nothing unless this scan changed an entry.
+        if (!cache->save ())
+            std::cerr << "Warning: could not write scan cache: " << options.cacheFile << std::endl;
+        if (!options.quiet)
+        {
+            logLine ("Scan cache: " + std::to_string (cache->hits () - hitsBefore) +
+                     " reused, " + std::to_string (cache->misses () - missesBefore) + " loaded");
+        }
+    }
+
+    const size_t cutOff = schedule.cutOff ();
+    if (cutOff > 0 && !options.quiet)
+        logLine ("Scan budget of " + std::to_string (options.budgetSec) + " s used up; " +
+                 std::to_string (cutOff) + " plugins not scanned");
+}
+
+std::vector<PluginInfo> scanPluginsWith (const std::vector<std::string>& paths,
+                                         const ScanOptions& options, ScanSession& session)
+{
+    std::vector<PluginInfo> results (paths.size ());
+    scanPluginsWith (
+        paths, options,
+        [&results] (size_t index, PluginInfo&& info) { results[index] = std::move (info); },
+        session);
+    // Every result carries its path; empty slots are plugins a budget cut off.
+    results.erase (std::remove_if (results.begin (), results.end (),
+                                   [] (const PluginInfo& p) { return p.path.empty (); }),
+                   results.end ());
+    return results;
+}
+
+} // anonymous
+
+//------------------------------------------------------------------------
+void scanPlugins (const std::vector<std::string>& paths, const ScanOptions& options,
+                  const PluginResultCallback& onResult)
+{
+    ScanSession session (options, resolveJobCount (options, paths.size ()));
+    scanPluginsWith (paths, options, onResult, session);
+}
+
+std::vector<PluginInfo> scanPlugins (const std::vector<std::string>& paths,
+                                     const ScanOptions& options)
+{
+    ScanSession session (options, resolveJobCount (options, paths.size ()));
+    return scanPluginsWith (paths, options, session);
+}
+
+//------------------------------------------------------------------------
+std::vector<AbandonedLoad> abandonedLoads ()
+{
+    return AbandonedLoadRegistry::instance ().snapshot ();
+}
+
+size_t abandonedLoadsStillRunning ()
+{
+    return AbandonedLoadRegistry::instance ().stillRunning ();
+}
+
+//------------------------------------------------------------------------
+namespace {
+
+constexpr uint64_t kEveryByte = 0x0101010101010101ull;
+constexpr uint64_t kHighBits = 0x8080808080808080ull;
+
+// Nonzero if any of the 8 bytes in word is a quote, a backslash or below 0x20. May flag more
+// bytes than those (borrows propagate), so callers only use it to decide which words to look
+// at byte by byte.
+inline uint64_t wordNeedsEscape (uint64_t word)
+{
+    const uint64_t quote = word ^ (kEveryByte * '"');
+    const uint64_t backslash = word ^ (kEveryByte * '\\');
+    return (((quote - kEveryByte) & ~quote) | ((backslash - kEveryByte) & ~backslash) |
+            ((word - kEveryByte * 0x20) & ~word)) &
+           kHighBits;
+}
+
+void appendEscape (std::string& out, unsigned char c)
+{
+    static const char hex[] = "0123456789abcdef";
+    switch (c)
+    {
+        case '\\': out += "\\\\"; break;
+        case '\"': out += "\\\""; break;
+        case '\b': out += "\\b"; break;
+        case '\f': out += "\\f"; break;
+        case '\n': out += "\\n"; break;
+        case '\r': out += "\\r"; break;
+        case '\t': out += "\\t"; break;
+        default:
+        {
+            const char escape[] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+            out.append (escape, sizeof (escape));
+            break;
+        }
+    }
+}
+
+// Appends data to out as the inside of a JSON string. Clean text is skipped eight bytes at a
+// time and copied in one append per run; only words that may hold a character to escape are
+// looked at byte by byte.
+void appendEscapedJSON (std::string& out, const char* data, size_t size)
+{
+    size_t runStart = 0;
+    size_t i = 0;
+    while (i < size)
+    {
+        for (; i + 8 <= size; i += 8)
+        {
+            uint64_t word;
+            std::memcpy (&word, data + i, sizeof (word));
+            if (wordNeedsEscape (word))
+                break;
+        }
+
+        const size_t stop = (std::min) (i + 8, size);
+        for (; i < stop; ++i)
+        {
+            const auto c = static_cast<unsigned char> (data[i]);
+            if (c >= 0x20 && c != '"' && c != '\\')
+                continue;
+            out.append (data + runStart, i - runStart);
+            appendEscape (out, c);
+            runStart = i + 1;
+        }
+    }
+    out.append (data + runStart, size - runStart);
+}
+
+} // anonymous
+
+//------------------------------------------------------------------------
+std::string escapeJSONString (const std::string& input)
+{
+    std::string result;
+    result.reserve (input.length ());
+    appendEscapedJSON (result, input.data (), input.size ());
+    return result;
+}
+
+//------------------------------------------------------------------------
+namespace {
+
+// Collects JSON text and hands it to the stream in blocks of kBlockSize with one write each
+// (a file stream passes a block that size straight to the kernel). Strings are escaped into
+// the block in place and numbers formatted with to_chars, so values need no temporaries.
+// Whatever is left is written by flush () or the destructor. Whole-catalog output owns a
+// buffer that reserves a full block; writers of one record at a time (NDJSON lines, server
+// replies) pass in storage they keep across records, so a record costs no allocation once
+// that storage has grown to record size.
+class JSONBuffer
+{
+public:
+    static constexpr size_t kBlockSize = 64 * 1024;
+
+    explicit JSONBuffer (std::ostream& out) : out (out), buffer (ownBuffer)
+    {
+        buffer.reserve (kBlockSize + 1024);
+    }
+
+    JSONBuffer (std::ostream& out, std::string& storage) : out (out), buffer (storage)
+    {
+        buffer.clear ();
+    }
+
+    ~JSONBuffer () { flush (); }
+
+    JSONBuffer (const JSONBuffer&) = delete;
+    JSONBuffer& operator= (const JSONBuffer&) = delete;
+
+    JSONBuffer& operator<< (const char* text)
+    {
+        buffer.append (text);
+        return spill ();
+    }
+
+    JSONBuffer& operator<< (const std::string& text)
+    {
+        buffer.append (text);
+        return spill ();
+    }
+
+    JSONBuffer& operator<< (char c)
+    {
+        buffer += c;
+        return spill ();
+    }
+
+    template <typename T, typename = std::enable_if_t<std::is_integral<T>::value>>
+    JSONBuffer& operator<< (T value)
+    {
+        char digits[24];
+        const auto end = std::to_chars (digits, digits + sizeof (digits), value).ptr;
+        buffer.append (digits, static_cast<size_t> (end - digits));
+        return spill ();
+    }
+
+    // value as a quoted, escaped JSON string.
+    JSONBuffer& quoted (const std::string& value)
+    {
+        buffer += '"';
+        appendEscapedJSON (buffer, value.data (), value.size ());
+        buffer += '"';
+        return spill ();
+    }
+
+    void flush ()
+    {
+        if (buffer.empty ())
+            return;
+        out.write (buffer.data (), static_cast<std::streamsize> (buffer.size ()));
+        buffer.clear ();
+    }
+
+private:
+    JSONBuffer& spill ()
+    {
+        if (buffer.size () >= kBlockSize)
+            flush ();
+        return *this;
+    }
+
+    std::ostream& out;
+    std::string ownBuffer;
+    std::string& buffer;
+};
+
+// Writes the fields of one JSON object either one per line at catalog indentation (pretty)
+// or all on one line (NDJSON). Callers emit the value right after field ().
+class JSONObjectWriter
+{
+public:
+    JSONObjectWriter (JSONBuffer& out, bool pretty) : out (out), pretty (pretty) {}
+
+    JSONBuffer& field (const char* key)
+    {
+        if (first)
+            out << (pretty ? "    {\n      \"" : "{\"");
+        else
+            out << (pretty ? ",\n      \"" : ", \"");
+        first = false;
+        return out << key << "\": ";
+    }
+
+    void string (const char* key, const std::string& value) { field (key).quoted (value); }
+
+    void boolean (const char* key, bool value) { field (key) << (value ? "true" : "false"); }
+
+    void close () { out << (pretty ? "\n    }" : "}"); }
+
+    bool isPretty () const { return pretty; }
+
+private:
+    JSONBuffer& out;
+    const bool pretty;
+    bool first {true};
+};
+
+void outputStringArrayJSON (const std::vector<std::string>& values, JSONBuffer& out)
+{
+    out << '[';
+    for (size_t j = 0; j < values.size (); ++j)
+    {
+        if (j > 0)
+            out << ", ";
+        out.quoted (values[j]);
+    }
+    out << ']';
+}
+
+// The analysis object always stays on its field's line, so the pretty catalog keeps one line
+// per plugin field and diffs between scans stay readable.
+void outputAnalysisJSON (const ModuleAnalysis& analysis, JSONBuffer& out)
+{
+    out << "{\"moduleSize\": " << analysis.moduleSize << ", \"licenseWrappers\": ";
+    outputStringArrayJSON (analysis.licenseWrappers, out);
+    out << ", \"licenseMarkers\": " << (analysis.licenseMarkers ? "true" : "false")
+        << ", \"headlessUnsafeVendor\": " << (analysis.headlessUnsafeVendor ? "true" : "false");
+    if (!analysis.binaryProblem.empty ())
+        (out << ", \"binaryProblem\": ").quoted (analysis.binaryProblem);
+    out << '}';
+}
+
+// One line per class, so a shell module with hundreds of classes stays scannable.
+void outputClassesJSON (const std::vector<PluginClassInfo>& classes, JSONBuffer& out,
+                        bool pretty)
+{
+    out << '[';
+    for (size_t j = 0; j < classes.size (); ++j)
+    {
+        if (j > 0)
+            out << ',';
+        if (pretty)
+            out << "\n        ";
+        else if (j > 0)
+            out << ' ';
+
+        const auto& entry = classes[j];
+        JSONObjectWriter obj (out, false);
+        obj.string ("name", entry.name);
+        obj.string ("category", entry.category);
+        outputStringArrayJSON (entry.subCategories, obj.field ("subCategories"));
+        obj.string ("cid", entry.cid);
+        obj.string ("vendor", entry.vendor);
+        obj.string ("version", entry.version);
+        obj.string ("sdkVersion", entry.sdkVersion);
+        obj.field ("cardinality") << entry.cardinality;
+        obj.field ("flags") << entry.flags;
+        obj.close ();
+    }
+    out << (pretty && !classes.empty () ? "\n      ]" : "]");
+}
+
+void outputTimingsJSON (const ScanTimings& t, JSONBuffer& out)
+{
+    out << "{\"cacheUs\": " << t.cacheUs << ", \"analyzeUs\": " << t.analyzeUs
+        << ", \"moduleLoadUs\": " << t.moduleLoadUs << ", \"classInfoUs\": " << t.classInfoUs
+        << ", \"workerUs\": " << t.workerUs << ", \"totalUs\": " << t.totalUs << '}';
+}
+
+// withTimings adds this run's ScanTimings (--profile); entries carried over from an earlier
+// catalog have none and get none.
+void outputPluginJSON (const PluginInfo& plugin, JSONObjectWriter& obj, bool withTimings = false)
+{
+    obj.string ("path", plugin.path);
+    obj.boolean ("isValid", plugin.isValid);
+    if (!plugin.scanSource.empty ())
+        obj.string ("scanSource", plugin.scanSource);
+    if (!plugin.aliases.empty ())
+        outputStringArrayJSON (plugin.aliases, obj.field ("aliases"));
+    if (plugin.analysis.analyzed)
+        outputAnalysisJSON (plugin.analysis, obj.field ("analysis"));
+
+    if (plugin.isValid)
+    {
+        obj.string ("name", plugin.name);
+        obj.string ("vendor", plugin.vendor);
+        obj.string ("version", plugin.version);
+        obj.string ("cid", plugin.cid);
+        obj.string ("sdkVersion", plugin.sdkVersion);
+        obj.field ("cardinality") << plugin.cardinality;
+        obj.field ("flags") << plugin.flags;
+
+        outputStringArrayJSON (plugin.categories, obj.field ("categories"));
+        if (!plugin.classes.empty ())
+            outputClassesJSON (plugin.classes, obj.field ("classes"), obj.isPretty ());
+    }
+    else
+    {
+        obj.boolean ("missingLicense", plugin.missingLicense);
+        obj.boolean ("failed", plugin.loadFailed);
+        obj.boolean ("loadTimedOut", plugin.loadTimedOut);
+        obj.string ("error", plugin.errorMessage);
+    }
+
+    if (withTimings && plugin.timings.totalUs > 0)
+        outputTimingsJSON (plugin.timings, obj.field ("timings"));
+
+    obj.close ();
+}
+
+std::string scanTimestamp ()
+{
+    return std::to_string (std::chrono::system_clock::now ().time_since_epoch ().count ());
+}
+
+} // anonymous
+
+//------------------------------------------------------------------------
+// With a profile (--profile), the catalog also carries the run's aggregate timings and each
+// plugin scanned in this run its own.
+void outputJSON (const std::vector<PluginInfo>& plugins, std::ostream& out,
+                 const ScanProfile* profile)
+{
+    out << "{\n";
+    out << "  \"scanTime\": \"" << scanTimestamp () << "\",\n";
+    out << "  \"totalPlugins\": " << plugins.size () << ",\n";
+    out << "  \"validPlugins\": "
+        << std::count_if (plugins.begin (), plugins.end (),
+                          [] (const PluginInfo& p) { return p.isValid; })
+        << ",\n";
+    if (profile)
+    {
+        out << "  \"profile\": ";
+        profile->writeJSON (out);
+        out << ",\n";
+    }
+    out << "  \"plugins\": [\n";
+
+    JSONBuffer json (out);
+    for (size_t i = 0; i < plugins.size (); ++i)
+    {
+        JSONObjectWriter obj (json, true);
+        outputPluginJSON (plugins[i], obj, profile != nullptr);
+        json << (i < plugins.size () - 1 ? ",\n" : "\n");
+    }
+    json << "  ]\n}\n";
+}
+
+//------------------------------------------------------------------------
+// One plugin object per line, flushed as soon as it is written, so a killed scan keeps every
+// finished record and consumers can start reading immediately. Safe to call from several scan
+// workers at once. writeSummary () appends the closing summary record.
+NDJSONWriter::NDJSONWriter (std::ostream& out, ScanProfile* profile)
+: out (out), profile (profile)
+{
+}
+
+void NDJSONWriter::write (const PluginInfo& plugin)
+{
+    std::lock_guard<std::mutex> lock (mutex);
+    JSONBuffer line (out, lineBuffer);
+    JSONObjectWriter obj (line, false);
+    obj.string ("type", "plugin");
+    outputPluginJSON (plugin, obj, profile != nullptr);
+    line << '\n';
+    line.flush ();
+    out.flush ();
+    counts.add (plugin);
+    if (profile)
+        profile->add (plugin.timings);
+}
+
+void NDJSONWriter::writeSummary ()
+{
+    std::lock_guard<std::mutex> lock (mutex);
+    out << "{\"type\": \"summary\", \"scanTime\": \"" << scanTimestamp ()
+        << "\", \"totalPlugins\": " << counts.total << ", \"validPlugins\": " << counts.valid
+        << ", \"missingLicense\": " << counts.missingLicense << ", \"failed\": " << counts.failed;
+    if (profile)
+    {
+        out << ", \"profile\": ";
+        profile->writeJSON (out);
+    }
+    out << "}\n";
+    out.flush ();
+}
+
+ScanTotals NDJSONWriter::totals ()
+{
+    std::lock_guard<std::mutex> lock (mutex);
+    return counts;
+}
+
+//------------------------------------------------------------------------
+ScanTrace::Track& ScanTrace::addTrack (std::string name)
+{
+    std::lock_guard<std::mutex> lock (mutex);
+    tracks.push_back (std::unique_ptr<Track> (new Track (epoch, std::move (name))));
+    return *tracks.back ();
+}
+
+// Complete ("X") events; every track is one thread of pid 1, named through metadata events.
+void ScanTrace::writeJSON (std::ostream& out) const
+{
+    std::lock_guard<std::mutex> lock (mutex);
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    out << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": 0, "
+           "\"args\": {\"name\": \"vst_scanner\"}}";
+    for (size_t tid = 0; tid < tracks.size (); ++tid)
+    {
+        const auto& track = *tracks[tid];
+        out << ",\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << tid
+            << ", \"args\": {\"name\": \"" << escapeJSONString (track.name) << "\"}}";
+        out << ",\n{\"name\": \"thread_sort_index\", \"ph\": \"M\", \"pid\": 1, \"tid\": "
+            << tid << ", \"args\": {\"sort_index\": " << tid << "}}";
+        for (const auto& event : track.events)
+        {
+            out << ",\n{\"name\": \"" << event.name << "\", \"cat\": \"scan\", \"ph\": \"X\", "
+                << "\"ts\": " << event.startUs << ", \"dur\": " << event.durationUs
+                << ", \"pid\": 1, \"tid\": " << tid;
+            if (!event.path.empty ())
+            {
+                out << ", \"args\": {\"path\": \"" << escapeJSONString (event.path) << "\"";
+                if (event.outcome)
+                    out << ", \"result\": \"" << event.outcome << "\"";
+                out << "}";
+            }
+            out << "}";
+        }
+    }
+    out << "\n]}\n";
+}
+
+//------------------------------------------------------------------------
+void ScanProfile::Phase::add (uint32_t us)
+{
+    // Values below 8 get a bucket each; above, the top 3 bits below the leading one pick one
+    // of 8 buckets within the power of two.
+    size_t bucket = us;
+    if (us >= 8)
+    {
+        int exponent = 31;
+        while ((us >> exponent) == 0)
+            --exponent;
+        bucket = static_cast<size_t> (exponent - 2) * 8 + ((us >> (exponent - 3)) & 7);
+    }
+    ++buckets[bucket];
+    ++count;
+    totalUs += us;
+    maxUs = (std::max) (maxUs, us);
+}
+
+// Upper bound of the bucket holding the q-th sample, capped by the exact maximum.
+uint32_t ScanProfile::Phase::percentile (double q) const
+{
+    if (count == 0)
+        return 0;
+    const auto rank = static_cast<uint64_t> (std::ceil (q * static_cast<double> (count)));
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < kBucketCount; ++bucket)
+    {
+        seen += buckets[bucket];
+        if (seen < (std::max) (rank, uint64_t (1)))
+            continue;
+        if (bucket < 8)
+            return static_cast<uint32_t> (bucket);
+        const unsigned shift = static_cast<unsigned> (bucket / 8 - 1);
+        const uint64_t upper = ((uint64_t (8 + bucket % 8) + 1) << shift) - 1;
+        return static_cast<uint32_t> ((std::min) (upper, uint64_t (maxUs)));
+    }
+    return maxUs;
+}
+
+const char* ScanProfile::phaseName (size_t phase)
+{
+    static const char* names[kPhaseCount] = {"cache",     "analyze", "moduleLoad",
+                                             "classInfo", "worker",  "total"};
+    return names[phase];
+}
+
+void ScanProfile::add (const ScanTimings& t)
+{
+    const uint32_t values[kPhaseCount] = {t.cacheUs,     t.analyzeUs, t.moduleLoadUs,
+                                          t.classInfoUs, t.workerUs,  t.totalUs};
+    std::lock_guard<std::mutex> lock (mutex);
+    for (size_t phase = 0; phase < kPhaseCount; ++phase)
+    {
+        if (values[phase] > 0)
+            phases[phase].add (values[phase]);
+    }
+}
+
+void ScanProfile::writeJSON (std::ostream& out) const
+{
+    std::lock_guard<std::mutex> lock (mutex);
+    out << "{\"discoveryMs\": " << discoveryMs << ", \"scanMs\": " << scanMs
+        << ", \"phases\": {";
+    for (size_t phase = 0; phase < kPhaseCount; ++phase)
+    {
+        const auto& p = phases[phase];
+        out << (phase > 0 ? ", " : "") << "\"" << phaseName (phase) << "\": {\"count\": "
+            << p.count << ", \"p50Us\": " << p.percentile (0.5)
+            << ", \"p95Us\": " << p.percentile (0.95) << ", \"maxUs\": " << p.maxUs
+            << ", \"totalUs\": " << p.totalUs << "}";
+    }
+    out << "}}";
+}
+
+void ScanProfile::writeSummary (std::ostream& out) const
+{
+    std::lock_guard<std::mutex> lock (mutex);
+    out << "Profile: discovery " << discoveryMs << " ms, scan " << scanMs << " ms" << std::endl;
+    for (size_t phase = 0; phase < kPhaseCount; ++phase)
+    {
+        const auto& p = phases[phase];
+        if (p.count == 0)
+            continue;
+        out << "  " << phaseName (phase) << ": n=" << p.count << " p50=" << p.percentile (0.5)
+            << "us p95=" << p.percentile (0.95) << "us max=" << p.maxUs << "us" << std::endl;
+    }
+}
+
+//------------------------------------------------------------------------
+// Binary catalog (--format bin). Everything a consumer needs sits at fixed offsets, so the
+// file can be mapped and queried in place:
+//
+//   header | plugin records | class records | string lists | path index | CID index | strings
+//
+// Strings are stored once each (vendors and categories repeat heavily) and referenced by
+// offset/length; every one is also NUL-terminated. Each index is an open-addressing table of
+// (record index + 1), 0 = empty, sized to a power of two, keyed by the FNV-1a hash of the key.
+// Multi-byte fields are little-endian, sections 8-byte aligned. Bump kBinaryCatalogVersion
+// when any layout changes.
+namespace {
+
+constexpr uint32_t kBinaryCatalogMagic = 0x31425356; // "VSB1"
+constexpr uint32_t kBinaryCatalogVersion = 2;
+
+enum BinaryPluginStatus : uint32_t
+{
+    kBinaryValid = 1u << 0,
+    kBinaryMissingLicense = 1u << 1,
+    kBinaryLoadFailed = 1u << 2,
+    kBinaryLoadTimedOut = 1u << 3,
+    kBinaryAnalyzed = 1u << 4,
+    kBinaryLicenseMarkers = 1u << 5,
+    kBinaryHeadlessUnsafeVendor = 1u << 6,
+};
+
+} // anonymous
+
+struct BinaryStringRef {
+    uint32_t offset {0}; // into the string pool
+    uint32_t length {0};
+};
+
+struct BinaryListRef {
+    uint32_t first {0}; // index of the first element in its section
+    uint32_t count {0};
+};
+
+struct BinaryCatalogHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t pluginCount;
+    uint32_t classCount;
+    uint32_t listCount;      // BinaryStringRefs in the string-list section
+    uint32_t pathIndexSize;  // slots
+    uint32_t cidIndexSize;   // slots
+    uint32_t reserved;
+    uint64_t pluginsOffset;
+    uint64_t classesOffset;
+    uint64_t listsOffset;
+    uint64_t pathIndexOffset;
+    uint64_t cidIndexOffset;
+    uint64_t stringsOffset;
+    uint64_t stringsSize;
+};
+
+struct BinaryPluginRecord {
+    BinaryStringRef path, name, vendor, version, cid, sdkVersion, error, scanSource;
+    BinaryStringRef binaryProblem;
+    BinaryListRef categories;      // string lists
+    BinaryListRef licenseWrappers; // string lists
+    BinaryListRef classes;         // class records
+    BinaryListRef aliases;         // string lists
+    int32_t cardinality;
+    uint32_t flags;
+    uint32_t status; // BinaryPluginStatus bits
+    uint32_t reserved;
+    uint64_t moduleSize;
+};
+
+struct BinaryClassRecord {
+    BinaryStringRef name, category, cid, vendor, version, sdkVersion;
+    BinaryListRef subCategories; // string lists
+    int32_t cardinality;
+    uint32_t flags;
+};
+
+static_assert (sizeof (BinaryCatalogHeader) == 88, "binary catalog header layout changed");
+static_assert (sizeof (BinaryPluginRecord) == 128, "binary plugin record layout changed");
+static_assert (sizeof (BinaryClassRecord) == 64, "binary class record layout changed");
+
+//------------------------------------------------------------------------
+namespace {
+
+uint64_t binaryCatalogHash (const char* data, size_t size)
+{
+    uint64_t hash = 1469598103934665603ull;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= static_cast<unsigned char> (data[i]);
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+size_t alignTo8 (size_t value)
+{
+    return (value + 7) & ~size_t (7);
+}
+
+class BinaryCatalogBuilder
+{
+public:
+    BinaryStringRef intern (const std::string& value)
+    {
+        const auto hit = pool.find (value);
+        if (hit != pool.end ())
+            return hit->second;
+        const BinaryStringRef ref {static_cast<uint32_t> (strings.size ()),
+                                   static_cast<uint32_t> (value.size ())};
+        strings.append (value).push_back ('\0');
+        pool.emplace (value, ref);
+        return ref;
+    }
+
+    BinaryListRef internList (const std::vector<std::string>& values)
+    {
+        const BinaryListRef ref {static_cast<uint32_t> (lists.size ()),
+                                 static_cast<uint32_t> (values.size ())};
+        for (const auto& value : values)
+            lists.push_back (intern (value));
+        return ref;
+    }
+
+    std::string build (const std::vector<PluginInfo>& plugins)
+    {
+        std::vector<BinaryPluginRecord> records;
+        std::vector<BinaryClassRecord> classes;
+        records.reserve (plugins.size ());
+
+        for (const auto& plugin : plugins)
+        {
+            BinaryPluginRecord record {};
+            record.path = intern (plugin.path);
+            record.name = intern (plugin.name);
+            record.vendor = intern (plugin.vendor);
+            record.version = intern (plugin.version);
+            record.cid = intern (plugin.cid);
+            record.sdkVersion = intern (plugin.sdkVersion);
+            record.error = intern (plugin.errorMessage);
+            record.scanSource = intern (plugin.scanSource);
+            record.binaryProblem = intern (plugin.analysis.binaryProblem);
+            record.categories = internList (plugin.categories);
+            record.licenseWrappers = internList (plugin.analysis.licenseWrappers);
+            record.classes = {static_cast<uint32_t> (classes.size ()),
+                              static_cast<uint32_t> (plugin.classes.size ())};
+            record.aliases = internList (plugin.aliases);
+            record.cardinality = plugin.cardinality;
+            record.flags = plugin.flags;
+            record.status = (plugin.isValid ? kBinaryValid : 0u) |
+                            (plugin.missingLicense ? kBinaryMissingLicense : 0u) |
+                            (plugin.loadFailed ? kBinaryLoadFailed : 0u) |
+                            (plugin.loadTimedOut ? kBinaryLoadTimedOut : 0u) |
+                            (plugin.analysis.analyzed ? kBinaryAnalyzed : 0u) |
+                            (plugin.analysis.licenseMarkers ? kBinaryLicenseMarkers : 0u) |
+                            (plugin.analysis.headlessUnsafeVendor ? kBinaryHeadlessUnsafeVendor
+                                                                  : 0u);
+            record.moduleSize = plugin.analysis.moduleSize;
+            records.push_back (record);
+
+            for (const auto& entry : plugin.classes)
+            {
+                BinaryClassRecord classRecord {};
+                classRecord.name = intern (entry.name);
+                classRecord.category = intern (entry.category);
+                classRecord.cid = intern (entry.cid);
+                classRecord.vendor = intern (entry.vendor);
+                classRecord.version = intern (entry.version);
+                classRecord.sdkVersion = intern (entry.sdkVersion);
+                classRecord.subCategories = internList (entry.subCategories);
+                classRecord.cardinality = entry.cardinality;
+                classRecord.flags = entry.flags;
+                classes.push_back (classRecord);
+            }
+        }
+
+        // Path index: one key per plugin. CID index: the primary CID and every class CID.
+        IndexKeys pathKeys, cidKeys;
+        for (uint32_t i = 0; i < records.size (); ++i)
+        {
+            pathKeys.emplace_back (records[i].path, i);
+            if (records[i].cid.length > 0)
+                cidKeys.emplace_back (records[i].cid, i);
+            for (uint32_t c = 0; c < records[i].classes.count; ++c)
+            {
+                const auto& cid = classes[records[i].classes.first + c].cid;
+                if (cid.length > 0 && cid.offset != records[i].cid.offset) // interned: same text
+                    cidKeys.emplace_back (cid, i);
+            }
+        }
+        const auto pathIndex = buildIndex (pathKeys);
+        const auto cidIndex = buildIndex (cidKeys);
+
+        BinaryCatalogHeader header {};
+        header.magic = kBinaryCatalogMagic;
+        header.version = kBinaryCatalogVersion;
+        header.pluginCount = static_cast<uint32_t> (records.size ());
+        header.classCount = static_cast<uint32_t> (classes.size ());
+        header.listCount = static_cast<uint32_t> (lists.size ());
+        header.pathIndexSize = static_cast<uint32_t> (pathIndex.size ());
+        header.cidIndexSize = static_cast<uint32_t> (cidIndex.size ());
+
+        size_t offset = sizeof (header);
+        const auto place = [&offset] (size_t bytes) {
+            const size_t at = offset;
+            offset = alignTo8 (offset + bytes);
+            return static_cast<uint64_t> (at);
+        };
+        header.pluginsOffset = place (records.size () * sizeof (BinaryPluginRecord));
+        header.classesOffset = place (classes.size () * sizeof (BinaryClassRecord));
+        header.listsOffset = place (lists.size () * sizeof (BinaryStringRef));
+        header.pathIndexOffset = place (pathIndex.size () * sizeof (uint32_t));
+        header.cidIndexOffset = place (cidIndex.size () * sizeof (uint32_t));
+        header.stringsOffset = place (strings.size ());
+        header.stringsSize = strings.size ();
+
+        std::string out (offset, '\0');
+        const auto put = [&out] (uint64_t at, const void* data, size_t bytes) {
+            if (bytes > 0)
+                std::memcpy (&out[static_cast<size_t> (at)], data, bytes);
+        };
+        put (0, &header, sizeof (header));
+        put (header.pluginsOffset, records.data (), records.size () * sizeof (BinaryPluginRecord));
+        put (header.classesOffset, classes.data (), classes.size () * sizeof (BinaryClassRecord));
+        put (header.listsOffset, lists.data (), lists.size () * sizeof (BinaryStringRef));
+        put (header.pathIndexOffset, pathIndex.data (), pathIndex.size () * sizeof (uint32_t));
+        put (header.cidIndexOffset, cidIndex.data (), cidIndex.size () * sizeof (uint32_t));
+        put (header.stringsOffset, strings.data (), strings.size ());
+        return out;
+    }
+
+private:
+    using IndexKeys = std::vector<std::pair<BinaryStringRef, uint32_t>>;
+
+    std::vector<uint32_t> buildIndex (const IndexKeys& keys)
+    {
+        size_t slots = 1;
+        while (slots < keys.size () * 2)
+            slots <<= 1;
+        std::vector<uint32_t> table (slots, 0);
+        for (const auto& key : keys)
+        {
+            const char* text = strings.data () + key.first.offset;
+            size_t slot = binaryCatalogHash (text, key.first.length) & (slots - 1);
+            while (table[slot] != 0)
+                slot = (slot + 1) & (slots - 1);
+            table[slot] = key.second + 1;
+        }
+        return table;
+    }
+
+    std::unordered_map<std::string, BinaryStringRef> pool;
+    std::string strings;
+    std::vector<BinaryStringRef> lists;
+};
+
+} // anonymous
+
+//------------------------------------------------------------------------
+void outputBinaryCatalog (const std::vector<PluginInfo>& plugins, std::ostream& out)
+{
+    const auto bytes = BinaryCatalogBuilder ().build (plugins);
+    out.write (bytes.data (), static_cast<std::streamsize> (bytes.size ()));
+}
+
+//------------------------------------------------------------------------
+// Read-only view of a binary catalog, mapped rather than parsed. Opening validates the
+// header and that every section lies inside the file; record contents are bounds-checked
+// as they are read, so a damaged file yields empty strings instead of wild reads.
+class BinaryCatalog
+{
+public:
+    static constexpr size_t npos = static_cast<size_t> (-1);
+
+    explicit BinaryCatalog (const std::string& path) : file (path)
+    {
+        if (!file.valid () || file.size () < sizeof (BinaryCatalogHeader))
+            return;
+        std::memcpy (&header, file.data (), sizeof (header));
+        if (header.magic != kBinaryCatalogMagic || header.version != kBinaryCatalogVersion)
+            return;
+
+        const auto fits = [this] (uint64_t offset, uint64_t count, uint64_t size) {
+            return offset % 8 == 0 && offset <= file.size () &&
+                   count <= (file.size () - offset) / size;
+        };
+        const auto powerOfTwo = [] (uint32_t n) { return n != 0 && (n & (n - 1)) == 0; };
+        ok = fits (header.pluginsOffset, header.pluginCount, sizeof (BinaryPluginRecord)) &&
+             fits (header.classesOffset, header.classCount, sizeof (BinaryClassRecord)) &&
+             fits (header.listsOffset, header.listCount, sizeof (BinaryStringRef)) &&
+             fits (header.pathIndexOffset, header.pathIndexSize, sizeof (uint32_t)) &&
+             fits (header.cidIndexOffset, header.cidIndexSize, sizeof (uint32_t)) &&
+             fits (header.stringsOffset, header.stringsSize, 1) &&
+             powerOfTwo (header.pathIndexSize) && powerOfTwo (header.cidIndexSize);
+    }
+
+    static bool looksLikeBinaryCatalog (const char* data, size_t size)
+    {
+        uint32_t magic = 0;
+        if (size < sizeof (magic))
+            return false;
+        std::memcpy (&magic, data, sizeof (magic));
+        return magic == kBinaryCatalogMagic;
+    }
+
+    bool valid () const { return ok; }
+    size_t size () const { return ok ? header.pluginCount : 0; }
+
+    const BinaryPluginRecord& record (size_t i) const
+    {
+        return section<BinaryPluginRecord> (header.pluginsOffset)[i];
+    }
+
+    const BinaryClassRecord& classRecord (size_t i) const
+    {
+        return section<BinaryClassRecord> (header.classesOffset)[i];
+    }
+
+    std::string_view string (BinaryStringRef ref) const
+    {
+        if (ref.offset > header.stringsSize || ref.length > header.stringsSize - ref.offset)
+            return {};
+        return std::string_view (file.data () + header.stringsOffset + ref.offset, ref.length);
+    }
+
+    // Index of the plugin at path / with this CID (primary or any class), or npos.
+    size_t findPath (std::string_view path) const
+    {
+        return find (header.pathIndexOffset, header.pathIndexSize, path,
+                     [this] (size_t i, std::string_view key) {
+                         return string (record (i).path) == key;
+                     });
+    }
+
+    size_t findCid (std::string_view cid) const
+    {
+        return find (header.cidIndexOffset, header.cidIndexSize, cid,
+                     [this] (size_t i, std::string_view key) {
+                         const auto& r = record (i);
+                         if (string (r.cid) == key)
+                             return true;
+                         const auto classes = clamp (r.classes, header.classCount);
+                         for (uint32_t c = 0; c < classes.count; ++c)
+                         {
+                             if (string (classRecord (classes.first + c).cid) == key)
+                                 return true;
+                         }
+                         return false;
+                     });
+    }
+
+    PluginInfo plugin (size_t i) const
+    {
+        const auto& r = record (i);
+        PluginInfo info;
+        info.path = std::string (string (r.path));
+        info.name = std::string (string (r.name));
+        info.vendor = std::string (string (r.vendor));
+        info.version = std::string (string (r.version));
+        info.cid = std::string (string (r.cid));
+        info.sdkVersion = std::string (string (r.sdkVersion));
+        info.errorMessage = std::string (string (r.error));
+        info.scanSource = std::string (string (r.scanSource));
+        info.categories = stringList (r.categories);
+        info.aliases = stringList (r.aliases);
+        info.cardinality = r.cardinality;
+        info.flags = r.flags;
+        info.isValid = (r.status & kBinaryValid) != 0;
+        info.missingLicense = (r.status & kBinaryMissingLicense) != 0;
+        info.loadFailed = (r.status & kBinaryLoadFailed) != 0;
+        info.loadTimedOut = (r.status & kBinaryLoadTimedOut) != 0;
+        info.analysis.analyzed = (r.status & kBinaryAnalyzed) != 0;
+        info.analysis.licenseMarkers = (r.status & kBinaryLicenseMarkers) != 0;
+        info.analysis.headlessUnsafeVendor = (r.status & kBinaryHeadlessUnsafeVendor) != 0;
+        info.analysis.moduleSize = r.moduleSize;
+        info.analysis.licenseWrappers = stringList (r.licenseWrappers);
+        info.analysis.binaryProblem = std::string (string (r.binaryProblem));
+
+        const auto classes = clamp (r.classes, header.classCount);
+        for (uint32_t c = 0; c < classes.count; ++c)
+        {
+            const auto& cr = classRecord (classes.first + c);
+            PluginClassInfo entry;
+            entry.name = std::string (string (cr.name));
+            entry.category = std::string (string (cr.category));
+            entry.subCategories = stringList (cr.subCategories);
+            entry.cid = std::string (string (cr.cid));
+            entry.vendor = std::string (string (cr.vendor));
+            entry.version = std::string (string (cr.version));
+            entry.sdkVersion = std::string (string (cr.sdkVersion));
+            entry.cardinality = cr.cardinality;
+            entry.flags = cr.flags;
+            info.classes.push_back (std::move (entry));
+        }
+        return info;
+    }
+
+    std::vector<PluginInfo> plugins () const
+    {
+        std::vector<PluginInfo> all;
+        all.reserve (size ());
+        for (size_t i = 0; i < size (); ++i)
+            all.push_back (plugin (i));
+        return all;
+    }
+
+private:
+    template <typename T>
+    const T* section (uint64_t offset) const
+    {
+        return reinterpret_cast<const T*> (file.data () + offset);
+    }
+
+    std::vector<std::string> stringList (BinaryListRef list) const
+    {
+        std::vector<std::string> values;
+        const auto* refs = section<BinaryStringRef> (header.listsOffset);
+        list = clamp (list, header.listCount);
+        for (uint32_t j = 0; j < list.count; ++j)
+            values.emplace_back (string (refs[list.first + j]));
+        return values;
+    }
+
+    // Cuts a list down to the elements that exist in a section of sectionSize elements.
+    static BinaryListRef clamp (BinaryListRef list, uint32_t sectionSize)
+    {
+        if (list.first > sectionSize)
+            return {};
+        list.count = (std::min) (list.count, sectionSize - list.first);
+        return list;
+    }
+
+    template <typename Match>
+    size_t find (uint64_t offset, uint32_t slots, std::string_view key, Match matches) const
+    {
+        if (!ok)
+            return npos;
+        const auto* table = section<uint32_t> (offset);
+        size_t slot = binaryCatalogHash (key.data (), key.size ()) & (slots - 1);
+        for (uint32_t probes = 0; probes < slots && table[slot] != 0; ++probes)
+        {
+            const size_t i = table[slot] - 1;
+            if (i < header.pluginCount && matches (i, key))
+                return i;
+            slot = (slot + 1) & (slots - 1);
+        }
+        return npos;
+    }
+
+    MappedFile file;
+    BinaryCatalogHeader header {};
+    bool ok {false};
+};
+
+//------------------------------------------------------------------------
+} // namespace VSTScanner
+
+//------------------------------------------------------------------------
+namespace VSTScanner {
+
+//------------------------------------------------------------------------
+namespace {
+
+// SAX-style JSON reader over an in-memory buffer (usually a MappedFile). Strings are unescaped
+// into one reused scratch buffer and numbers are handed over as raw text, so reading a catalog
+// allocates only for the values the handler keeps. Accepts any whitespace layout and any
+// number of top-level values, which also covers NDJSON. A lenient reader also takes comments
+// and trailing commas, the JSON5 subset that moduleinfo.json files are written in.
+class JSONReader
+{
+public:
+    struct Handler
+    {
+        virtual ~Handler () = default;
+        virtual void beginObject () {}
+        virtual void endObject () {}
+        virtual void beginArray () {}
+        virtual void endArray () {}
+        virtual void key (const std::string&) {}
+        virtual void string (const std::string&) {}
+        virtual void number (const char*, size_t) {}
+        virtual void boolean (bool) {}
+        virtual void null () {}
+    };
+
+    JSONReader (const char* data, size_t size, bool lenient = false)
+    : p (data), end (data + size), lenient (lenient)
+    {
+    }
+
+    // Returns false at the first syntax error. Events delivered before it stand, so a
+    // truncated file still yields every record that was complete.
+    bool parse (Handler& handler)
+    {
+        for (;;)
+        {
+            skipWhitespace ();
+            if (p == end)
+                return true;
+            if (!parseValue (handler, 0))
+                return false;
+        }
+    }
+
+private:
+    static constexpr int kMaxDepth = 64;
+
+    void skipWhitespace ()
+    {
+        for (;;)
+        {
+            while (p != end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t'))
+                ++p;
+            if (!lenient || end - p < 2 || p[0] != '/')
+                return;
+
+            if (p[1] == '/')
+            {
+                while (p != end && *p != '\n')
+                    ++p;
+            }
+            else if (p[1] == '*')
+            {
+                p += 2;
+                while (p != end && !(*p == '*' && end - p > 1 && p[1] == '/'))
+                    ++p;
+                p = p == end ? end : p + 2;
+            }
+            else
+                return;
+        }
+    }
+
+    bool consume (char c)
+    {
+        skipWhitespace ();
+        if (p == end || *p != c)
+            return false;
+        ++p;
+        return true;
+    }
+
+    bool literal (const char* word)
+    {
+        const size_t len = std::strlen (word);
+        if (static_cast<size_t> (end - p) < len || std::memcmp (p, word, len) != 0)
+            return false;
+        p += len;
+        return true;
+    }
+
+    bool parseValue (Handler& handler, int depth)
+    {
+        skipWhitespace ();
+        if (p == end || depth > kMaxDepth)
+            return false;
+
+        switch (*p)
+        {
+            case '{': return parseObject (handler, depth);
+            case '[': return parseArray (handler, depth);
+            case '"':
+                if (!parseString ())
+                    return false;
+                handler.string (scratch);
+                return true;
+            case 't':
+                if (!literal ("true"))
+                    return false;
+                handler.boolean (true);
+                return true;
+            case 'f':
+                if (!literal ("false"))
+                    return false;
+                handler.boolean (false);
+                return true;
+            case 'n':
+                if (!literal ("null"))
+                    return false;
+                handler.null ();
+                return true;
+            default: return parseNumber (handler);
+        }
+    }
+
+    bool parseObject (Handler& handler, int depth)
+    {
+        ++p;
+        handler.beginObject ();
+        if (consume ('}'))
+        {
+            handler.endObject ();
+            return true;
+        }
+        do
+        {
+            skipWhitespace ();
+            if (lenient && p != end && *p == '}')
+                break;
+            if (p == end || *p != '"' || !parseString ())
+                return false;
+            handler.key (scratch);
+            if (!consume (':') || !parseValue (handler, depth + 1))
+                return false;
+        } while (consume (','));
+        if (!consume ('}'))
+            return false;
+        handler.endObject ();
+        return true;
+    }
+
+    bool parseArray (Handler& handler, int depth)
+    {
+        ++p;
+        handler.beginArray ();
+        if (consume (']'))
+        {
+            handler.endArray ();
+            return true;
+        }
+        do
+        {
+            skipWhitespace ();
+            if (lenient && p != end && *p == ']')
+                break;
+            if (!parseValue (handler, depth + 1))
+                return false;
+        } while (consume (','));
+        if (!consume (']'))
+            return false;
+        handler.endArray ();
+        return true;
+    }
+
+    bool parseNumber (Handler& handler)
+    {
+        const char* start = p;
+        if (p != end && *p == '-')
+            ++p;
+        while (p != end && ((*p >= '0' && *p <= '9') || *p == '.' || *p == 'e' || *p == 'E' ||
+                            *p == '+' || *p == '-'))
+            ++p;
+        if (p == start)
+            return false;
+        handler.number (start, static_cast<size_t> (p - start));
+        return true;
+    }
+
+    static int hexDigit (char c)
+    {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+        return -1;
+    }
+
+    bool parseHex4 (uint32_t& value)
+    {
+        if (end - p < 4)
+            return false;
+        value = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            const int digit = hexDigit (*p++);
+            if (digit < 0)
+                return false;
+            value = (value << 4) | static_cast<uint32_t> (digit);
+        }
+        return true;
+    }
+
+    void appendUtf8 (uint32_t cp)
+    {
+        if (cp < 0x80)
+            scratch += static_cast<char> (cp);
+        else if (cp < 0x800)
+        {
+            scratch += static_cast<char> (0xC0 | (cp >> 6));
+            scratch += static_cast<char> (0x80 | (cp & 0x3F));
+        }
+        else if (cp < 0x10000)
+        {
+            scratch += static_cast<char> (0xE0 | (cp >> 12));
+            scratch += static_cast<char> (0x80 | ((cp >> 6) & 0x3F));
+            scratch += static_cast<char> (0x80 | (cp & 0x3F));
+        }
+        else
+        {
+            scratch += static_cast<char> (0xF0 | (cp >> 18));
+            scratch += static_cast<char> (0x80 | ((cp >> 12) & 0x3F));
+            scratch += static_cast<char> (0x80 | ((cp >> 6) & 0x3F));
+            scratch += static_cast<char> (0x80 | (cp & 0x3F));
+        }
+    }
+
+    // Unescapes the string at p (opening quote included) into scratch.
+    bool parseString ()
+    {
+        ++p;
+        scratch.clear ();
+        for (;;)
+        {
+            // Copy the run up to the next quote or escape in one append.
+            const char* run = p;
+            while (p != end && *p != '"' && *p != '\\')
+                ++p;
+            scratch.append (run, static_cast<size_t> (p - run));
+            if (p == end)
+                return false;
+            if (*p++ == '"')
+                return true;
+
+            if (p == end)
+                return false;
+            switch (*p++)
+            {
+                case '"': scratch += '"'; break;
+                case '\\': scratch += '\\'; break;
+                case '/': scratch += '/'; break;
+                case 'b': scratch += '\b'; break;
+                case 'f': scratch += '\f'; break;
+                case 'n': scratch += '\n'; break;
+                case 'r': scratch += '\r'; break;
+                case 't': scratch += '\t'; break;
+                case 'u':
+                {
+                    uint32_t cp = 0;
+                    if (!parseHex4 (cp))
+                        return false;
+                    if (cp >= 0xD800 && cp < 0xDC00 && end - p >= 6 && p[0] == '\\' && p[1] == 'u')
+                    {
+                        const char* save = p;
+                        p += 2;
+                        uint32_t low = 0;
+                        if (parseHex4 (low) && low >= 0xDC00 && low < 0xE000)
+                            cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                        else
+                            p = save;
+                    }
+                    appendUtf8 (cp);
+                    break;
+                }
+                default: return false;
+            }
+        }
+    }
+
+    const char* p;
+    const char* end;
+    const bool lenient;
+    std::string scratch;
+};
+
+//------------------------------------------------------------------------
+// Builds PluginInfo records from either a catalog ({"plugins": [ {...}, ... ]}) or NDJSON
+// ({"type": "plugin", ...} per line). Unknown keys and containers are skipped.
+class CatalogHandler : public JSONReader::Handler
+{
+public:
+    explicit CatalogHandler (std::vector<PluginInfo>& plugins) : plugins (plugins)
+    {
+        roles.reserve (8);
+    }
+
+    void beginObject () override
+    {
+        Role role = Role::ignored;
+        if (roles.empty ())
+            role = Role::plugin; // catalog root or an NDJSON record; see endObject
+        else if (roles.back () == Role::pluginsArray)
+            role = Role::plugin;
+        else if (roles.back () == Role::plugin && lastKey == "analysis")
+            role = Role::analysis;
+        else if (roles.back () == Role::classesArray)
+            role = Role::classObject;
+
+        if (role == Role::plugin)
+        {
+            current = PluginInfo ();
+            recordType.clear ();
+        }
+        else if (role == Role::analysis)
+        {
+            current.analysis = ModuleAnalysis ();
+            current.analysis.analyzed = true;
+        }
+        else if (role == Role::classObject)
+        {
+            current.classes.emplace_back ();
+        }
+        roles.push_back (role);
+    }
+
+    void endObject () override
+    {
+        const Role role = roles.back ();
+        roles.pop_back ();
+        if (role != Role::plugin)
+            return;
+        if (!roles.empty () || recordType == "plugin")
+            plugins.push_back (std::move (current));
+    }
+
+    void beginArray () override
+    {
+        Role role = Role::ignored;
+        if (!roles.empty () && roles.back () == Role::plugin)
+        {
+            if (roles.size () == 1 && lastKey == "plugins")
+                role = Role::pluginsArray;
+            else if (lastKey == "categories" || lastKey == "subCategories")
+            {
+                role = Role::categories;
+                current.categories.clear ();
+            }
+            else if (lastKey == "classes")
+            {
+                role = Role::classesArray;
+                current.classes.clear ();
+            }
+            else if (lastKey == "aliases")
+            {
+                role = Role::aliases;
+                current.aliases.clear ();
+            }
+        }
+        else if (!roles.empty () && roles.back () == Role::classObject &&
+                 lastKey == "subCategories")
+        {
+            role = Role::classSubCategories;
+        }
+        else if (!roles.empty () && roles.back () == Role::analysis && lastKey == "licenseWrappers")
+        {
+            role = Role::wrappers;
+        }
+        roles.push_back (role);
+    }
+
+    void endArray () override { roles.pop_back (); }
+
+    void key (const std::string& name) override { lastKey = name; }
+
+    void string (const std::string& value) override
+    {
+        if (roles.empty ())
+            return;
+
+        switch (roles.back ())
+        {
+            case Role::categories: current.categories.push_back (value); break;
+            case Role::wrappers: current.analysis.licenseWrappers.push_back (value); break;
+            case Role::aliases: current.aliases.push_back (value); break;
+            case Role::analysis:
+                if (lastKey == "binaryProblem")
+                    current.analysis.binaryProblem = value;
+                break;
+            case Role::classSubCategories:
+                current.classes.back ().subCategories.push_back (value);
+                break;
+            case Role::classObject:
+            {
+                auto& entry = current.classes.back ();
+                if (lastKey == "name")
+                    entry.name = value;
+                else if (lastKey == "category")
+                    entry.category = value;
+                else if (lastKey == "cid")
+                    entry.cid = value;
+                else if (lastKey == "vendor")
+                    entry.vendor = value;
+                else if (lastKey == "version")
+                    entry.version = value;
+                else if (lastKey == "sdkVersion")
+                    entry.sdkVersion = value;
+                break;
+            }
+            case Role::plugin:
+                if (lastKey == "path")
+                    current.path = value;
+                else if (lastKey == "name")
+                    current.name = value;
+                else if (lastKey == "vendor")
+                    current.vendor = value;
+                else if (lastKey == "version")
+                    current.version = value;
+                else if (lastKey == "cid")
+                    current.cid = value;
+                else if (lastKey == "sdkVersion")
+                    current.sdkVersion = value;
+                else if (lastKey == "error")
+                    current.errorMessage = value;
+                else if (lastKey == "scanSource")
+                    current.scanSource = value;
+                else if (lastKey == "type")
+                    recordType = value;
+                break;
+            default: break;
+        }
+    }
+
+    void number (const char* text, size_t length) override
+    {
+        if (roles.empty () || length >= 32)
+            return;
+        char buffer[32];
+        std::memcpy (buffer, text, length);
+        buffer[length] = '\0';
+
+        if (roles.back () == Role::plugin && lastKey == "cardinality")
+            current.cardinality = static_cast<int32_t> (std::strtol (buffer, nullptr, 10));
+        else if (roles.back () == Role::plugin && lastKey == "flags")
+            current.flags = static_cast<uint32_t> (std::strtoul (buffer, nullptr, 10));
+        else if (roles.back () == Role::analysis && lastKey == "moduleSize")
+            current.analysis.moduleSize = std::strtoull (buffer, nullptr, 10);
+        else if (roles.back () == Role::classObject && lastKey == "cardinality")
+            current.classes.back ().cardinality =
+                static_cast<int32_t> (std::strtol (buffer, nullptr, 10));
+        else if (roles.back () == Role::classObject && lastKey == "flags")
+            current.classes.back ().flags =
+                static_cast<uint32_t> (std::strtoul (buffer, nullptr, 10));
+    }
+
+    void boolean (bool value) override
+    {
+        if (roles.empty ())
+            return;
+
+        if (roles.back () == Role::plugin)
+        {
+            if (lastKey == "isValid")
+                current.isValid = value;
+            else if (lastKey == "missingLicense")
+                current.missingLicense = value;
+            else if (lastKey == "failed")
+                current.loadFailed = value;
+            else if (lastKey == "loadTimedOut")
+                current.loadTimedOut = value;
+        }
+        else if (roles.back () == Role::analysis)
+        {
+            if (lastKey == "licenseMarkers")
+                current.analysis.licenseMarkers = value;
+            else if (lastKey == "headlessUnsafeVendor")
+                current.analysis.headlessUnsafeVendor = value;
+        }
+    }
+
+private:
+    enum class Role : uint8_t
+    {
+        ignored,
+        plugin,
+        pluginsArray,
+        categories,
+        aliases,
+        analysis,
+        wrappers,
+        classesArray,
+        classObject,
+        classSubCategories,
+    };
+
+    std::vector<PluginInfo>& plugins;
+    std::vector<Role> roles;
+    std::string lastKey;
+    std::string recordType;
+    PluginInfo current;
+};
+
+} // anonymous
+
+//------------------------------------------------------------------------
+std::vector<PluginInfo> parseJSONCatalog (const char* data, size_t size)
+{
+    std::vector<PluginInfo> plugins;
+    CatalogHandler handler (plugins);
+    JSONReader (data, size).parse (handler);
+    return plugins;
+}
+
+//------------------------------------------------------------------------
+std::vector<PluginInfo> parseExistingJSON (const std::string& filename)
+{
+    const MappedFile mapped (filename);
+    if (mapped.valid ())
+    {
+        mapped.adviseSequential (0, mapped.size ());
+        return parseJSONCatalog (mapped.data (), mapped.size ());
+    }
+
+    std::ifstream file (filename, std::ios::binary);
+    if (!file.is_open ())
+        return {};
+    const std::string text ((std::istreambuf_iterator<char> (file)),
+                            std::istreambuf_iterator<char> ());
+    return parseJSONCatalog (text.data (), text.size ());
+}
+
+//------------------------------------------------------------------------
+class BinaryCatalogView::Impl : public BinaryCatalog
+{
+public:
+    using BinaryCatalog::BinaryCatalog;
+};
+
+BinaryCatalogView::BinaryCatalogView (const std::string& filename)
+: impl (std::make_unique<Impl> (filename))
+{
+}
+
+BinaryCatalogView::~BinaryCatalogView () = default;
+
+bool BinaryCatalogView::valid () const
+{
+    return impl->valid ();
+}
+
+size_t BinaryCatalogView::size () const
+{
+    return impl->size ();
+}
+
+size_t BinaryCatalogView::findPath (std::string_view path) const
+{
+    return impl->findPath (path);
+}
+
+size_t BinaryCatalogView::findCid (std::string_view cid) const
+{
+    return impl->findCid (cid);
+}
+
+std::string_view BinaryCatalogView::path (size_t index) const
+{
+    return impl->string (impl->record (index).path);
+}
+
+std::string_view BinaryCatalogView::name (size_t index) const
+{
+    return impl->string (impl->record (index).name);
+}
+
+std::string_view BinaryCatalogView::vendor (size_t index) const
+{
+    return impl->string (impl->record (index).vendor);
+}
+
+std::string_view BinaryCatalogView::cid (size_t index) const
+{
+    return impl->string (impl->record (index).cid);
+}
+
+bool BinaryCatalogView::isValid (size_t index) const
+{
+    return (impl->record (index).status & kBinaryValid) != 0;
+}
+
+PluginInfo BinaryCatalogView::plugin (size_t index) const
+{
+    return impl->plugin (index);
+}
+
+std::vector<PluginInfo> BinaryCatalogView::plugins () const
+{
+    return impl->plugins ();
+}
+
+//------------------------------------------------------------------------
+// Reads a catalog in any format this scanner writes: JSON, NDJSON or binary.
+std::vector<PluginInfo> loadCatalogFile (const std::string& filename)
+{
+    const BinaryCatalogView binary (filename);
+    if (binary.valid ())
+        return binary.plugins ();
+    return parseExistingJSON (filename);
+}
+
+//------------------------------------------------------------------------
+namespace {
+
+// Collects the classes of a moduleinfo.json ("Factory Info", "Classes": [{"CID", "Category",
+// "Name", ...}]). Classes without their own vendor or version take the factory's vendor and
+// the module's version, as the SDK's moduleinfo parser does.
+class ModuleInfoHandler : public JSONReader::Handler
+{
+public:
+    void beginObject () override
+    {
+        Role role = Role::ignored;
+        if (roles.empty ())
+            role = Role::root;
+        else if (roles.back () == Role::root && lastKey == "Factory Info")
+            role = Role::factoryInfo;
+        else if (roles.back () == Role::classesArray)
+        {
+            role = Role::classObject;
+            classes.emplace_back ();
+        }
+        roles.push_back (role);
+    }
+
+    void endObject () override { roles.pop_back (); }
+
+    void beginArray () override
+    {
+        Role role = Role::ignored;
+        if (!roles.empty () && roles.back () == Role::root && lastKey == "Classes")
+            role = Role::classesArray;
+        else if (!roles.empty () && roles.back () == Role::classObject &&
+                 lastKey == "Sub Categories")
+            role = Role::subCategories;
+        roles.push_back (role);
+    }
+
+    void endArray () override { roles.pop_back (); }
+
+    void key (const std::string& name) override { lastKey = name; }
+
+    void string (const std::string& value) override
+    {
+        if (roles.empty ())
+            return;
+
+        switch (roles.back ())
+        {
+            case Role::root:
+                if (lastKey == "Version")
+                    moduleVersion = value;
+                break;
+            case Role::factoryInfo:
+                if (lastKey == "Vendor")
+                    factoryVendor = value;
+                break;
+            case Role::subCategories: classes.back ().subCategories.push_back (value); break;
+            case Role::classObject:
+            {
+                auto& entry = classes.back ();
+                if (lastKey == "CID")
+                    entry.cid = value;
+                else if (lastKey == "Category")
+                    entry.category = value;
+                else if (lastKey == "Name")
+                    entry.name = value;
+                else if (lastKey == "Vendor")
+                    entry.vendor = value;
+                else if (lastKey == "Version")
+                    entry.version = value;
+                else if (lastKey == "SDKVersion")
+                    entry.sdkVersion = value;
+                else if (lastKey == "Sub Categories")
+                    splitSubCategories (value, entry.subCategories); // "Fx|Delay" form
+                break;
+            }
+            default: break;
+        }
+    }
+
+    void number (const char* text, size_t length) override
+    {
+        if (roles.empty () || roles.back () != Role::classObject || length >= 32)
+            return;
+        char buffer[32];
+        std::memcpy (buffer, text, length);
+        buffer[length] = '\0';
+
+        if (lastKey == "Cardinality")
+            classes.back ().cardinality =
+                static_cast<int32_t> (std::strtoll (buffer, nullptr, 10));
+        else if (lastKey == "Class Flags")
+            classes.back ().flags = static_cast<uint32_t> (std::strtoull (buffer, nullptr, 10));
+    }
+
+    std::vector<PluginClassInfo> takeClasses ()
+    {
+        for (auto& entry : classes)
+        {
+            if (entry.vendor.empty ())
+                entry.vendor = factoryVendor;
+            if (entry.version.empty ())
+                entry.version = moduleVersion;
+        }
+        return std::move (classes);
+    }
+
+private:
+    enum class Role : uint8_t
+    {
+        ignored,
+        root,
+        factoryInfo,
+        classesArray,
+        classObject,
+        subCategories,
+    };
+
+    static void splitSubCategories (const std::string& value, std::vector<std::string>& out)
+    {
+        size_t start = 0;
+        while (start <= value.size ())
+        {
+            const size_t bar = (std::min) (value.find ('|', start), value.size ());
+            if (bar > start)
+                out.push_back (value.substr (start, bar - start));
+            start = bar + 1;
+        }
+    }
+
+    std::vector<PluginClassInfo> classes;
+    std::vector<Role> roles;
+    std::string lastKey;
+    std::string factoryVendor;
+    std::string moduleVersion;
+};
+
+} // anonymous
+
+//------------------------------------------------------------------------
+bool readModuleInfo (const std::filesystem::path& modulePath, PluginInfo& info)
+{
+    std::error_code ec;
+    const auto file = modulePath / "Contents" / "Resources" / "moduleinfo.json";
+    if (!std::filesystem::is_regular_file (file, ec))
+        return false;
+
+    std::ifstream in (file, std::ios::binary);
+    if (!in.is_open ())
+        return false;
+    const std::string text ((std::istreambuf_iterator<char> (in)),
+                            std::istreambuf_iterator<char> ());
+
+    ModuleInfoHandler handler;
+    if (!JSONReader (text.data (), text.size (), true).parse (handler))
+        return false;
+    auto classes = handler.takeClasses ();
+    if (classes.empty ())
+        return false;
+
+    info.classes = std::move (classes);
+    fillPluginInfoFromClasses (info);
+    info.scanSource = "moduleinfo";
+    return true;
+}
+
+//------------------------------------------------------------------------
+namespace {
+
+// Paths from different scans of the same module can differ in "./" segments, trailing
+// separators and (on Windows) case and separator style.
+std::string mergePathKey (const std::string& path)
+{
+    std::string key = std::filesystem::path (path).lexically_normal ().generic_string ();
+    while (key.size () > 1 && key.back () == '/')
+        key.pop_back ();
+#if SMTG_OS_WINDOWS
+    key = toLowerAscii (std::move (key));
+#endif
+    return key;
+}
+
+bool mergeReplaces (const PluginInfo& held, const PluginInfo& incoming, MergePolicy policy)
+{
+    switch (policy)
+    {
+        case MergePolicy::keepOld: return false;
+        case MergePolicy::replaceWithNewer: return true;
+        case MergePolicy::keepValidOverFailed: return incoming.isValid || !held.isValid;
+    }
+    return false;
+}
+
+} // anonymous
+
+//------------------------------------------------------------------------
+// Merges in one pass over both lists, looking matches up by hashed path key (and CID when
+// asked), so large cumulative catalogs merge in linear time. Records are moved, never copied.
+// The result keeps first-seen order; a replaced record takes over its predecessor's position.
+std::vector<PluginInfo> mergePlugins (std::vector<PluginInfo> existing,
+                                      std::vector<PluginInfo> newPlugins,
+                                      const MergeOptions& options)
+{
+    std::vector<PluginInfo> merged;
+    merged.reserve (existing.size () + newPlugins.size ());
+    std::unordered_map<std::string, size_t> byPath;
+    byPath.reserve (existing.size () + newPlugins.size ());
+    std::unordered_map<std::string, size_t> byCid;
+
+    auto add = [&] (PluginInfo&& plugin) {
+        std::string key = mergePathKey (plugin.path);
+        size_t slot = merged.size ();
+
+        const auto pathHit = byPath.find (key);
+        if (pathHit != byPath.end ())
+            slot = pathHit->second;
+        else if (options.matchCid && !plugin.cid.empty ())
+        {
+            const auto cidHit = byCid.find (plugin.cid);
+            if (cidHit != byCid.end () && merged[cidHit->second].cid == plugin.cid)
+                slot = cidHit->second;
+        }
+
+        if (slot == merged.size ())
+        {
+            byPath.emplace (std::move (key), slot);
+            if (options.matchCid && !plugin.cid.empty ())
+                byCid.emplace (plugin.cid, slot);
+            merged.push_back (std::move (plugin));
+            return;
+        }
+
+        if (!mergeReplaces (merged[slot], plugin, options.policy))
+            return;
+        byPath.emplace (std::move (key), slot);
+        if (options.matchCid && !plugin.cid.empty ())
+            byCid[plugin.cid] = slot;
+        merged[slot] = std::move (plugin);
+    };
+
+    for (auto& plugin : existing)
+        add (std::move (plugin));
+    for (auto& plugin : newPlugins)
+        add (std::move (plugin));
+
+    return merged;
+}
+
+#if SMTG_OS_LINUX
+//------------------------------------------------------------------------
+namespace {
+
+std::atomic<bool> watchStopRequested {false};
+
+// A stream of events that never pauses for the debounce window still gets rescanned this often.
+constexpr auto kMaxDebounceDelay = std::chrono::seconds (30);
+
+class InotifyWatcher
+{
+public:
+    InotifyWatcher () : fd (::inotify_init1 (IN_NONBLOCK | IN_CLOEXEC)) {}
+    ~InotifyWatcher ()
+    {
+        if (fd >= 0)
+            ::close (fd);
+    }
+
+    InotifyWatcher (const InotifyWatcher&) = delete;
+    InotifyWatcher& operator= (const InotifyWatcher&) = delete;
+
+    bool valid () const { return fd >= 0; }
+    int handle () const { return fd; }
+
+    // inotify is not recursive: every directory below dir gets its own watch, bundle internals
+    // included, since a replaced bundle binary only shows up as an event inside Contents/.
+    void watchTree (const std::filesystem::path& dir)
+    {
+        addWatch (dir);
+        std::error_code ec;
+        std::filesystem::recursive_directory_iterator it (
+            dir, std::filesystem::directory_options::skip_permission_denied, ec);
+        for (; !ec && it != std::filesystem::recursive_directory_iterator (); it.increment (ec))
+        {
+            if (!it->is_symlink (ec) && it->is_directory (ec))
+                addWatch (it->path ());
+        }
+    }
+
+    // Appends the path of every pending event, and whether it names a directory.
+    void drain (std::vector<std::pair<std::string, bool>>& events)
+    {
+        alignas (struct inotify_event) char buffer[64 * 1024];
+        for (;;)
+        {
+            const ssize_t n = ::read (fd, buffer, sizeof (buffer));
+            if (n <= 0)
+                return;
+
+            for (const char* p = buffer; p < buffer + n;)
+            {
+                const auto* event = reinterpret_cast<const struct inotify_event*> (p);
+                p += sizeof (struct inotify_event) + event->len;
+
+                if (event->mask & IN_Q_OVERFLOW)
+                {
+                    overflowed = true;
+                    continue;
+                }
+                if (event->mask & IN_IGNORED)
+                {
+                    dirs.erase (event->wd);
+                    continue;
+                }
+                const auto dir = dirs.find (event->wd);
+                if (dir == dirs.end () || event->len == 0)
+                    continue;
+                events.emplace_back ((std::filesystem::path (dir->second) / event->name).string (),
+                                     (event->mask & IN_ISDIR) != 0);
+            }
+        }
+    }
+
+    // True once after the kernel dropped events; only a full rescan is safe then.
+    bool takeOverflow () { return std::exchange (overflowed, false); }
+
+private:
+    void addWatch (const std::filesystem::path& dir)
+    {
+        constexpr uint32_t kMask = IN_CREATE | IN_DELETE | IN_MODIFY | IN_CLOSE_WRITE |
+                                   IN_MOVED_FROM | IN_MOVED_TO | IN_DONT_FOLLOW | IN_EXCL_UNLINK;
+        const int wd = ::inotify_add_watch (fd, dir.c_str (), kMask);
+        if (wd >= 0)
+            dirs[wd] = dir.string (); // a renamed directory keeps its wd; take the new path
+        else if (errno == ENOSPC && !warnedLimit)
+        {
+            warnedLimit = true;
+            logLine ("Watch: inotify watch limit reached (fs.inotify.max_user_watches); "
+                     "changes below " + dir.string () + " and some other directories are missed");
+        }
+    }
+
+    int fd;
+    std::unordered_map<int, std::string> dirs;
+    bool overflowed {false};
+    bool warnedLimit {false};
+};
+
+// What an event means for the catalog: the bundle it happened in, the module file itself,
+// or the directory that appeared or vanished. Empty for anything else.
+std::string watchTargetForEvent (const std::string& root, const std::string& path, bool isDir)
+{
+    std::filesystem::path prefix (root);
+    for (const auto& part : std::filesystem::path (path).lexically_relative (root))
+    {
+        prefix /= part;
+        if (part.extension () == kVst3Extension)
+            return prefix.string ();
+    }
+    if (isDir || std::filesystem::path (path).extension () == kSharedLibExtension)
+        return path;
+    return {};
+}
+
+// Rescans the collected targets: modules that appeared are loaded, modules that were touched
+// are reloaded, and catalog entries whose module is gone are dropped. Modules that were only
+// rediscovered by walking a directory keep their entry. Returns whether the catalog changed.
+bool applyWatchTargets (std::vector<std::string> targets, bool reloadAll,
+                        std::vector<PluginInfo>& catalog, InotifyWatcher& watcher,
+                        const ScanOptions& options, ScanSession& session)
+{
+    std::unordered_map<std::string, size_t> index;
+    std::unordered_map<std::string, std::string> primaryOf; // alias -> catalog path
+    for (size_t i = 0; i < catalog.size (); ++i)
+    {
+        index.emplace (catalog[i].path, i);
+        for (const auto& alias : catalog[i].aliases)
+            primaryOf.emplace (alias, catalog[i].path);
+    }
+
+    std::vector<std::string> toLoad;
+    std::unordered_set<std::string> present;
+    std::unordered_map<std::string, std::vector<std::string>> foundAliases;
+    for (const auto& target : targets)
+    {
+        std::error_code ec;
+        const std::filesystem::directory_entry entry (target, ec);
+        if (ec || !entry.exists (ec))
+            continue;
+
+        // Watch before walking, so nothing created in between goes unseen.
+        if (entry.is_directory (ec))
+            watcher.watchTree (target);
+
+        std::vector<DiscoveredModule> found;
+        bool reloadFound = reloadAll;
+        if (classifyEntry (entry) == EntryKind::module)
+        {
+            found.push_back ({target, {}});
+            reloadFound = true;
+        }
+        else if (entry.is_directory (ec))
+        {
+            found = discoverModules (target);
+        }
+
+        // A module reached through one of its aliases is the catalog entry it belongs to.
+        for (auto& module : found)
+        {
+            auto path = std::move (module.path);
+            const auto primary = primaryOf.find (path);
+            if (primary != primaryOf.end ())
+                path = primary->second;
+            if (reloadFound || index.count (path) == 0)
+                toLoad.push_back (path);
+            if (!module.aliases.empty ())
+            {
+                auto& aliases = foundAliases[path];
+                aliases.insert (aliases.end (), module.aliases.begin (), module.aliases.end ());
+            }
+            present.insert (std::move (path));
+        }
+    }
+    std::sort (toLoad.begin (), toLoad.end ());
+    toLoad.erase (std::unique (toLoad.begin (), toLoad.end ()), toLoad.end ());
+
+    const auto removedEnd = std::remove_if (catalog.begin (), catalog.end (),
+                                            [&] (const PluginInfo& plugin) {
+                                                if (present.count (plugin.path) != 0)
+                                                    return false;
+                                                for (const auto& target : targets)
+                                                {
+                                                    if (isSameOrBelow (plugin.path, target))
+                                                        return true;
+                                                }
+                                                return false;
+                                            });
+    const size_t removed = static_cast<size_t> (catalog.end () - removedEnd);
+    catalog.erase (removedEnd, catalog.end ());
+    if (removed > 0)
+    {
+        index.clear ();
+        for (size_t i = 0; i < catalog.size (); ++i)
+            index.emplace (catalog[i].path, i);
+    }
+
+    size_t added = 0, updated = 0;
+    for (auto& info : scanPluginsWith (toLoad, options, session))
+    {
+        // A subtree walk only sees the links inside it; keep the aliases found before.
+        const auto known = index.find (info.path);
+        const auto aliases = foundAliases.find (info.path);
+        if (known != index.end ())
+            info.aliases = catalog[known->second].aliases;
+        if (aliases != foundAliases.end ())
+            info.aliases.insert (info.aliases.end (), aliases->second.begin (),
+                                 aliases->second.end ());
+        std::sort (info.aliases.begin (), info.aliases.end ());
+        info.aliases.erase (std::unique (info.aliases.begin (), info.aliases.end ()),
+                            info.aliases.end ());
+
+        if (known != index.end ())
+        {
+            catalog[known->second] = std::move (info);
+            ++updated;
+        }
+        else
+        {
+            catalog.push_back (std::move (info));
+            ++added;
+        }
+    }
+
+    if (added + updated + removed == 0)
+        return false;
+    logLine ("Watch: " + std::to_string (added) + " added, " + std::to_string (updated) +
+             " updated, " + std::to_string (removed) + " removed");
+    return true;
+}
+
+} // anonymous
+
+//------------------------------------------------------------------------
+void stopWatching ()
+{
+    watchStopRequested = true;
+}
+
+//------------------------------------------------------------------------
+// Keeps catalog in sync with the modules below root until stopWatching () is called.
+// Changes are collected until root has been quiet for debounceMs, so an installer writing
+// hundreds of files costs one rescan. onChanged receives the catalog after every rescan that
+// altered it. Returns false if inotify is unavailable.
+bool watchPlugins (const std::string& root, std::vector<PluginInfo>& catalog,
+                   const ScanOptions& options, const WatchOptions& watchOptions,
+                   const CatalogChangedCallback& onChanged)
+{
+    InotifyWatcher watcher;
+    if (!watcher.valid ())
+    {
+        logLine (std::string ("Watch: inotify unavailable: ") + std::strerror (errno));
+        return false;
+    }
+    watcher.watchTree (root);
+    if (!options.quiet)
+        logLine ("Watching " + root + " for changes (Ctrl+C to stop)");
+
+    // Sized for the largest rescan; the pool is forked by the first rescan that loads.
+    ScanSession session (options, resolveJobCount (options, SIZE_MAX));
+
+    const auto debounce = std::chrono::milliseconds (watchOptions.debounceMs);
+    std::set<std::string> targets;
+    bool overflowed = false;
+    std::chrono::steady_clock::time_point firstChange, lastChange;
+    std::vector<std::pair<std::string, bool>> events;
+
+    while (!watchStopRequested)
+    {
+        // Short timeout so a stop request is noticed without a wakeup pipe.
+        pollfd pfd {watcher.handle (), POLLIN, 0};
+        ::poll (&pfd, 1, 250);
+
+        const auto now = std::chrono::steady_clock::now ();
+        const bool wasPending = !targets.empty () || overflowed;
+        events.clear ();
+        watcher.drain (events);
+        for (const auto& event : events)
+        {
+            auto target = watchTargetForEvent (root, event.first, event.second);
+            if (target.empty ())
+                continue;
+            targets.insert (std::move (target));
+            lastChange = now;
+        }
+        if (watcher.takeOverflow ())
+        {
+            overflowed = true;
+            lastChange = now;
+        }
+
+        if (targets.empty () && !overflowed)
+            continue;
+        if (!wasPending)
+            firstChange = now;
+        if (now - lastChange < debounce && now - firstChange < kMaxDebounceDelay)
+            continue;
+
+        std::vector<std::string> batch (targets.begin (), targets.end ());
+        if (overflowed)
+        {
+            logLine ("Watch: event queue overflowed; rescanning " + root);
+            batch.assign (1, root);
+        }
+        const bool changed = applyWatchTargets (std::move (batch), overflowed, catalog, watcher,
+                                                options, session);
+        targets.clear ();
+        overflowed = false;
+        if (changed && onChanged)
+            onChanged (catalog);
+    }
+    return true;
+}
+#endif // SMTG_OS_LINUX
+
+#if SMTG_OS_LINUX || SMTG_OS_MACOS
+//------------------------------------------------------------------------
+// Keeps a catalog resident and answers line-based queries on a Unix domain socket, one
+// connection per thread. Each request is one line, "<verb> <argument>":
+//
+//   path <path>       cid <cid>       vendor <name>       category <name>
+//   since <generation>                all                 stats
+//
+// The answer is one JSON object per line: {"type": "plugin", "generation": G, ...} records
+// (plus {"type": "removed", ...} for since), closed by {"type": "end", "generation": G,
+// "count": N}. Every entry remembers the generation in which it last changed, so a client
+// that saw generation N asks "since N" to catch up. Vendor and category match
+// case-insensitively; cid also finds shell modules by any of their class IDs.
+class CatalogServer::Impl
+{
+public:
+    explicit Impl (std::string socketPath) : socketPath (std::move (socketPath)) {}
+    ~Impl () { stop (); }
+
+    bool start (const std::vector<PluginInfo>& catalog)
+    {
+        update (catalog);
+
+        sockaddr_un address {};
+        address.sun_family = AF_UNIX;
+        if (socketPath.size () >= sizeof (address.sun_path))
+        {
+            logLine ("Serve: socket path too long: " + socketPath);
+            return false;
+        }
+        std::memcpy (address.sun_path, socketPath.c_str (), socketPath.size () + 1);
+
+        // Replace a socket left behind by a previous server, but never any other file.
+        struct stat st {};
+        if (::lstat (socketPath.c_str (), &st) == 0 && S_ISSOCK (st.st_mode))
+            ::unlink (socketPath.c_str ());
+
+        listenFd = ::socket (AF_UNIX, SOCK_STREAM, 0);
+        if (listenFd < 0 ||
+            ::bind (listenFd, reinterpret_cast<sockaddr*> (&address), sizeof (address)) != 0 ||
+            ::listen (listenFd, 64) != 0 || ::pipe (wakePipe) != 0)
+        {
+            logLine ("Serve: cannot listen on " + socketPath + ": " + std::strerror (errno));
+            closeListener ();
+            return false;
+        }
+        for (const int fd : {listenFd, wakePipe[0], wakePipe[1]})
+            ::fcntl (fd, F_SETFD, FD_CLOEXEC);
+        // Nonblocking, so a client that hangs up between poll and accept cannot block the
+        // acceptor.
+        ::fcntl (listenFd, F_SETFL, ::fcntl (listenFd, F_GETFL) | O_NONBLOCK);
+
+        acceptor = std::thread ([this] () { acceptLoop (); });
+        logLine ("Serving catalog on " + socketPath);
+        return true;
+    }
+
+    // Takes a new catalog snapshot. Entries whose content changed (or that are new) move to
+    // the next generation; entries that disappeared are remembered for "since" queries.
+    void update (const std::vector<PluginInfo>& catalog)
+    {
+        std::unique_lock<std::shared_mutex> lock (mutex);
+        const uint64_t next = generation + 1;
+        bool changed = false;
+
+        std::vector<uint64_t> generations (catalog.size (), next);
+        std::unordered_set<std::string> stillPresent;
+        for (size_t i = 0; i < catalog.size (); ++i)
+        {
+            const auto& plugin = catalog[i];
+            stillPresent.insert (plugin.path);
+            const auto previous = byPath.find (plugin.path);
+            if (previous != byPath.end () &&
+                serializePluginInfo (plugins[previous->second]) == serializePluginInfo (plugin))
+                generations[i] = entryGenerations[previous->second];
+            else
+                changed = true;
+        }
+        for (const auto& plugin : plugins)
+        {
+            if (stillPresent.count (plugin.path) == 0)
+            {
+                removed[plugin.path] = next;
+                changed = true;
+            }
+        }
+        for (const auto& path : stillPresent)
+            removed.erase (path);
+        if (!changed && generation > 0)
+            return;
+
+        generation = next;
+        plugins = catalog;
+        entryGenerations = std::move (generations);
+        rebuildIndexes ();
+    }
+
+    void stop ()
+    {
+        if (listenFd < 0)
+            return;
+        // shutdown () on a listening socket only wakes accept on Linux; macOS and the BSDs
+        // refuse it with ENOTCONN. The acceptor polls a wakeup pipe as well instead.
+        stopping = true;
+        const char wake = 1;
+        while (::write (wakePipe[1], &wake, 1) < 0 && errno == EINTR)
+            ;
+        if (acceptor.joinable ())
+            acceptor.join ();
+        closeListener ();
+        ::unlink (socketPath.c_str ());
+
+        // Client threads are detached; wake them and wait until the last one has left.
+        std::unique_lock<std::mutex> lock (clientsMutex);
+        for (const int fd : clientFds)
+            ::shutdown (fd, SHUT_RDWR);
+        clientsDone.wait (lock, [this] () { return clientFds.empty (); });
+    }
+
+    // Builds the full reply to one request line.
+    std::string answer (const std::string& request) const
+    {
+        const auto space = request.find (' ');
+        const auto verb = request.substr (0, space);
+        const auto argument =
+            space == std::string::npos ? std::string () : request.substr (space + 1);
+
+        std::shared_lock<std::shared_mutex> lock (mutex);
+        std::ostringstream out;
+        size_t count = 0;
+        std::string lineBuffer;
+        const auto emit = [&] (size_t index) {
+            JSONBuffer line (out, lineBuffer);
+            JSONObjectWriter obj (line, false);
+            obj.string ("type", "plugin");
+            obj.field ("generation") << entryGenerations[index];
+            outputPluginJSON (plugins[index], obj);
+            line << '\n';
+            ++count;
+        };
+        const auto emitAll = [&] (const MultiIndex& index, const std::string& key) {
+            const auto hit = index.find (key);
+            if (hit == index.end ())
+                return;
+            for (const size_t i : hit->second)
+                emit (i);
+        };
+
+        if (verb == "path")
+        {
+            const auto hit = byPath.find (argument);
+            if (hit != byPath.end ())
+                emit (hit->second);
+        }
+        else if (verb == "cid")
+            emitAll (byCid, toLowerAscii (argument));
+        else if (verb == "vendor")
+            emitAll (byVendor, toLowerAscii (argument));
+        else if (verb == "category")
+            emitAll (byCategory, toLowerAscii (argument));
+        else if (verb == "all")
+        {
+            for (size_t i = 0; i < plugins.size (); ++i)
+                emit (i);
+        }
+        else if (verb == "since")
+        {
+            const uint64_t since = std::strtoull (argument.c_str (), nullptr, 10);
+            for (size_t i = 0; i < plugins.size (); ++i)
+            {
+                if (entryGenerations[i] > since)
+                    emit (i);
+            }
+            for (const auto& entry : removed)
+            {
+                if (entry.second > since)
+                {
+                    out << "{\"type\": \"removed\", \"path\": \"" << escapeJSONString (entry.first)
+                        << "\", \"generation\": " << entry.second << "}\n";
+                    ++count;
+                }
+            }
+        }
+        else if (verb == "stats")
+        {
+            ScanTotals totals;
+            for (const auto& plugin : plugins)
+                totals.add (plugin);
+            out << "{\"type\": \"stats\", \"totalPlugins\": " << totals.total
+                << ", \"validPlugins\": " << totals.valid << ", \"missingLicense\": "
+                << totals.missingLicense << ", \"failed\": " << totals.failed << "}\n";
+        }
+        else
+        {
+            out << "{\"type\": \"error\", \"message\": \"unknown query: "
+                << escapeJSONString (verb) << "\"}\n";
+        }
+
+        out << "{\"type\": \"end\", \"generation\": " << generation << ", \"count\": " << count
+            << "}\n";
+        return out.str ();
+    }
+
+private:
+    using MultiIndex = std::unordered_map<std::string, std::vector<size_t>>;
+
+    void rebuildIndexes ()
+    {
+        byPath.clear ();
+        byCid.clear ();
+        byVendor.clear ();
+        byCategory.clear ();
+        byPath.reserve (plugins.size ());
+
+        const auto add = [] (MultiIndex& index, const std::string& key, size_t i) {
+            if (key.empty ())
+                return;
+            auto& slots = index[toLowerAscii (key)];
+            if (slots.empty () || slots.back () != i)
+                slots.push_back (i);
+        };
+
+        for (size_t i = 0; i < plugins.size (); ++i)
+        {
+            const auto& plugin = plugins[i];
+            byPath.emplace (plugin.path, i);
+            add (byCid, plugin.cid, i);
+            add (byVendor, plugin.vendor, i);
+            for (const auto& category : plugin.categories)
+                add (byCategory, category, i);
+            for (const auto& entry : plugin.classes)
+            {
+                add (byCid, entry.cid, i);
+                add (byVendor, entry.vendor, i);
+                for (const auto& category : entry.subCategories)
+                    add (byCategory, category, i);
+            }
+        }
+    }
+
+    void acceptLoop ()
+    {
+        while (!stopping)
+        {
+            pollfd fds[] = {{listenFd, POLLIN, 0}, {wakePipe[0], POLLIN, 0}};
+            if (::poll (fds, 2, -1) < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                return;
+            }
+            if (fds[1].revents != 0)
+                return; // stop () was called
+
+            const int fd = ::accept (listenFd, nullptr, nullptr);
+            if (fd < 0)
+            {
+                if (errno == EINTR || errno == ECONNABORTED || errno == EAGAIN ||
+                    errno == EWOULDBLOCK)
+                    continue;
+                return;
+            }
+            // BSD sockets inherit O_NONBLOCK from the listener; clients are served blocking.
+            ::fcntl (fd, F_SETFL, ::fcntl (fd, F_GETFL) & ~O_NONBLOCK);
+#ifdef SO_NOSIGPIPE
+            const int one = 1;
+            ::setsockopt (fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof (one));
+#endif
+            std::lock_guard<std::mutex> lock (clientsMutex);
+            clientFds.insert (fd);
+            std::thread ([this, fd] () { serveClient (fd); }).detach ();
+        }
+    }
+
+    void serveClient (int fd)
+    {
+        constexpr size_t kMaxRequest = 64 * 1024;
+        std::string pending;
+        char buffer[4096];
+        for (;;)
+        {
+            const ssize_t n = ::recv (fd, buffer, sizeof (buffer), 0);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                break;
+            pending.append (buffer, static_cast<size_t> (n));
+
+            size_t newline;
+            bool ok = true;
+            while (ok && (newline = pending.find ('\n')) != std::string::npos)
+            {
+                std::string request = pending.substr (0, newline);
+                pending.erase (0, newline + 1);
+                if (!request.empty () && request.back () == '\r')
+                    request.pop_back ();
+                ok = sendAll (fd, answer (request));
+            }
+            if (!ok || pending.size () > kMaxRequest)
+                break;
+        }
+
+        std::lock_guard<std::mutex> lock (clientsMutex);
+        clientFds.erase (fd);
+        ::close (fd);
+        clientsDone.notify_all ();
+    }
+
+    static bool sendAll (int fd, const std::string& data)
+    {
+#ifdef MSG_NOSIGNAL
+        constexpr int kFlags = MSG_NOSIGNAL;
+#else
+        constexpr int kFlags = 0;
+#endif
+        size_t sent = 0;
+        while (sent < data.size ())
+        {
+            const ssize_t n = ::send (fd, data.data () + sent, data.size () - sent, kFlags);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                return false;
+            sent += static_cast<size_t> (n);
+        }
+        return true;
+    }
+
+    void closeListener ()
+    {
+        if (listenFd >= 0)
+            ::close (listenFd);
+        listenFd = -1;
+        for (int& fd : wakePipe)
+        {
+            if (fd >= 0)
+                ::close (fd);
+            fd = -1;
+        }
+    }
+
+    const std::string socketPath;
+    int listenFd {-1};
+    int wakePipe[2] {-1, -1}; // written by stop () to wake the acceptor
+    std::atomic<bool> stopping {false};
+    std::thread acceptor;
+
+    std::mutex clientsMutex;
+    std::condition_variable clientsDone;
+    std::unordered_set<int> clientFds;
+
+    mutable std::shared_mutex mutex;
+    uint64_t generation {0};
+    std::vector<PluginInfo> plugins;
+    std::vector<uint64_t> entryGenerations;
+    std::unordered_map<std::string, uint64_t> removed;
+    std::unordered_map<std::string, size_t> byPath;
+    MultiIndex byCid;
+    MultiIndex byVendor;
+    MultiIndex byCategory;
+};
+
+CatalogServer::CatalogServer (std::string socketPath)
+: impl (std::make_unique<Impl> (std::move (socketPath)))
+{
+}
+
+CatalogServer::~CatalogServer () = default;
+
+bool CatalogServer::start (const std::vector<PluginInfo>& catalog)
+{
+    return impl->start (catalog);
+}
+
+void CatalogServer::update (const std::vector<PluginInfo>& catalog)
+{
+    impl->update (catalog);
+}
+
+void CatalogServer::stop ()
+{
+    impl->stop ();
+}
+
+//------------------------------------------------------------------------
+// Client side of CatalogServer: sends one request and copies the reply to out.
+// Returns false when the server cannot be reached or the reply ends early.
+bool queryCatalogServer (const std::string& socketPath, const std::string& request,
+                         std::ostream& out)
+{
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    if (socketPath.size () >= sizeof (address.sun_path))
+        return false;
+    std::memcpy (address.sun_path, socketPath.c_str (), socketPath.size () + 1);
+
+    const int fd = ::socket (AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0)
+        return false;
+    if (::connect (fd, reinterpret_cast<sockaddr*> (&address), sizeof (address)) != 0)
+    {
+        ::close (fd);
+        return false;
+    }
+
+    const std::string line = request + "\n";
+    bool ok = ::send (fd, line.data (), line.size (), 0) == static_cast<ssize_t> (line.size ());
+
+    // The reply is complete at the "end" record, which is always the last line.
+    std::string reply;
+    char buffer[64 * 1024];
+    while (ok)
+    {
+        const ssize_t n = ::recv (fd, buffer, sizeof (buffer), 0);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+        {
+            ok = false;
+            break;
+        }
+        reply.append (buffer, static_cast<size_t> (n));
+        if (reply.back () != '\n')
+            continue;
+        static const char kEndRecord[] = "{\"type\": \"end\",";
+        const auto previous =
+            reply.size () < 2 ? std::string::npos : reply.rfind ('\n', reply.size () - 2);
+        const auto start = previous == std::string::npos ? 0 : previous + 1;
+        if (reply.compare (start, sizeof (kEndRecord) - 1, kEndRecord) == 0)
+            break;
+    }
+    ::close (fd);
+
+    out << reply;
+    return ok;
+}
+#endif // SMTG_OS_LINUX || SMTG_OS_MACOS
+
+//------------------------------------------------------------------------
+} // namespace VSTScanner